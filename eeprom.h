@@ -19,14 +19,22 @@ struct MachineConfig {
   bool homeBeforeStart;
   bool useStartOffset;
   float backoffDistanceMM;
+  int jerk_W; // RPM/s^2, 0 = linear ramp
+  int jerk_T;
 };
 
 MachineConfig cfg;
 
 // --- SYSTEM CONSTANTS ---
 
-const int MAX_PRESETS = 25;
-const int EEPROM_CONF_ADDR = 0;
+// Limits enforced by areAnySettingNonsense(); the task queue's narrow
+// fields are sized for them (see the static_asserts in taskqueue.h)
+const int MAX_RPM = 4000;
+const int MAX_RAMP = 150; // RPM/s
+
+const int MAX_PRESETS = 20; // slots 20-24 of old firmware are the journal now
+const int LEGACY_MAX_PRESETS = 25;
+const int EEPROM_CONF_ADDR = 0;     // legacy config, only read to migrate
 const int EEPROM_PRESET_START = 50; // Start address for presets
 
 struct WindingPreset {
@@ -41,4 +49,45 @@ struct WindingPreset {
 
 WindingPreset active; // Currently loaded/edited parameters
 
+// --- PRESET DIRECTORY ---
+// Stored right after the preset slots: a magic byte, an 8-bit name hash per
+// slot and a bitmap of used slots. Lookups only read a preset's name on a
+// hash match, DELETE just clears the slot's bit (no shifting, no wear).
+#define PRESET_DIR_MAGIC 0xA5
+#define PRESET_BITMAP_BYTES ((MAX_PRESETS + 7) / 8)
+
+const int EEPROM_DIR_ADDR =
+    EEPROM_PRESET_START + MAX_PRESETS * sizeof(WindingPreset);
+const int EEPROM_DIR_HASHES = EEPROM_DIR_ADDR + 1;
+const int EEPROM_DIR_BITMAP = EEPROM_DIR_HASHES + MAX_PRESETS;
+
+// --- CONFIG JOURNAL ---
+// Every save appends a {seq, cfg, crc} record to the next slot of a small
+// ring; at boot the valid record with the newest sequence number wins, so a
+// torn write just falls back to the previous one. Wear is spread over the
+// ring, and SET BEGIN ... SET COMMIT turns a burst of SETs into one save.
+struct ConfigRecord {
+  uint16_t seq;
+  MachineConfig cfg;
+  uint16_t crc; // crc16() of seq and cfg
+};
+
+#define CONFIG_JOURNAL_RECORDS 6
+#define CONFIG_BATCH_TIMEOUT_MS 5000 // open SET BEGIN without COMMIT
+
+const int EEPROM_JOURNAL_START = EEPROM_DIR_BITMAP + PRESET_BITMAP_BYTES;
+
+#if defined(E2END)
+static_assert(EEPROM_JOURNAL_START +
+                      CONFIG_JOURNAL_RECORDS * sizeof(ConfigRecord) <=
+                  E2END + 1,
+              "Preset directory and config journal do not fit in EEPROM");
+#endif
+
+uint16_t configSeq = 0;   // sequence number of the newest record
+int8_t configSlot = -1;   // its slot, -1 = journal empty
+bool configBatch = false; // inside SET BEGIN ... SET COMMIT
+bool configDirty = false; // cfg changed since the last save
+unsigned long configLastChange = 0;
+
 #endif
\ No newline at end of file
@@ -3,7 +3,13 @@
 // --- EEPROM HELPERS ---
 
 void loadMachineConfiguration() {
-  EEPROM.get(EEPROM_CONF_ADDR, cfg);
+  initPresetDirectory();
+  if (!loadConfigJournal()) {
+    // Nothing journaled yet: take the config of older firmware (if any)
+    loadLegacyConfig();
+    if (!areAnySettingNonsense(cfg))
+      saveMachineConfiguration();
+  }
   if (areAnySettingNonsense(cfg)) { // First run defaults
     loadFallbackConfiguration();
   }
@@ -43,12 +49,95 @@ void loadFallbackConfiguration() {
       true,  // bool useLimitSwitch;
       false, // bool homeBeforeStart;
       true,  // bool useStartOffset;
-      2      // float backoffDistanceMM;
+      2,     // float backoffDistanceMM;
+      0,     // int jerk_W;
+      0      // int jerk_T;
   };
   saveMachineConfiguration();
 }
 
-void saveMachineConfiguration() { EEPROM.put(EEPROM_CONF_ADDR, cfg); }
+// --- CONFIG JOURNAL ---
+
+int configRecordAddress(int slot) {
+  return EEPROM_JOURNAL_START + slot * sizeof(ConfigRecord);
+}
+
+uint16_t configRecordCrc(const ConfigRecord &rec) {
+  return crc16((const uint8_t *)&rec, offsetof(ConfigRecord, crc));
+}
+
+// Loads the newest valid journal record into cfg
+bool loadConfigJournal() {
+  ConfigRecord rec;
+  configSlot = -1;
+  for (int i = 0; i < CONFIG_JOURNAL_RECORDS; i++) {
+    EEPROM.get(configRecordAddress(i), rec);
+    if (rec.crc != configRecordCrc(rec))
+      continue;
+    // Sequence numbers wrap, so compare the difference
+    if (configSlot == -1 || (int16_t)(rec.seq - configSeq) > 0) {
+      configSlot = i;
+      configSeq = rec.seq;
+      cfg = rec.cfg;
+    }
+  }
+  return configSlot != -1;
+}
+
+// Config of older firmware (a single copy at EEPROM_CONF_ADDR): everything
+// up to the jerk settings, which start as 0 (linear ramp, as before)
+void loadLegacyConfig() {
+  uint8_t *p = (uint8_t *)&cfg;
+  for (size_t i = 0; i < offsetof(MachineConfig, jerk_W); i++)
+    p[i] = EEPROM.read(EEPROM_CONF_ADDR + i);
+  cfg.jerk_W = 0;
+  cfg.jerk_T = 0;
+}
+
+// Appends cfg to the journal, or only marks it dirty inside SET BEGIN
+void saveMachineConfiguration() {
+  if (configBatch) {
+    configDirty = true;
+    configLastChange = millis();
+    return;
+  }
+
+  ConfigRecord rec;
+  memset(&rec, 0, sizeof(rec)); // padding is part of the CRC on some targets
+  rec.seq = configSeq + 1;
+  rec.cfg = cfg;
+  rec.crc = configRecordCrc(rec);
+
+  int8_t slot = (configSlot + 1) % CONFIG_JOURNAL_RECORDS;
+  EEPROM.put(configRecordAddress(slot), rec);
+  configSlot = slot;
+  configSeq = rec.seq;
+  configDirty = false;
+}
+
+void configBegin() {
+  configBatch = true;
+  configLastChange = millis();
+  Serial.println(F("SYSTEM: Config batch started, SET COMMIT saves it."));
+}
+
+void configCommit() {
+  configBatch = false;
+  if (configDirty) {
+    saveMachineConfiguration();
+    Serial.println(F("SYSTEM: Machine config saved to EEPROM."));
+  } else {
+    Serial.println(F("SYSTEM: Nothing to save."));
+  }
+}
+
+// A client that sent SET BEGIN and vanished must not lose the settings
+void configPoll() {
+  if (configBatch && millis() - configLastChange > CONFIG_BATCH_TIMEOUT_MS) {
+    Serial.println(F("WARNING: SET COMMIT missing, saving config batch."));
+    configCommit();
+  }
+}
 
 bool areAnySettingNonsense(const MachineConfig &c) {
   // 1. Screw pitch nie może być zerem ani ujemny (standard to 1.0 - 5.0)
@@ -62,9 +151,9 @@ bool areAnySettingNonsense(const MachineConfig &c) {
     return true;
 
   // 3. RPM-y: jeśli są ujemne lub absurdalnie wysokie (np. błąd odczytu float)
-  if (c.maxRPM_W <= 5 || c.maxRPM_W > 4000)
+  if (c.maxRPM_W <= 5 || c.maxRPM_W > MAX_RPM)
     return true;
-  if (c.maxRPM_T <= 5 || c.maxRPM_T > 4000)
+  if (c.maxRPM_T <= 5 || c.maxRPM_T > MAX_RPM)
     return true;
 
   // 4. Start RPM musi być mniejszy niż Max RPM
@@ -73,47 +162,124 @@ bool areAnySettingNonsense(const MachineConfig &c) {
   if (c.startRPM_T <= 0 || c.startRPM_T >= c.maxRPM_T)
     return true;
 
-  if (c.defaultRamp_W > 150)
+  if (c.defaultRamp_W > MAX_RAMP)
     return true;
-  if (c.defaultRamp_T > 150)
+  if (c.defaultRamp_T > MAX_RAMP)
+    return true;
+
+  if (c.jerk_W < 0 || c.jerk_W > 10000)
+    return true;
+  if (c.jerk_T < 0 || c.jerk_T > 10000)
     return true;
 
   return false; // Wszystko wygląda okej
 }
 
-int findPresetIndex(String name) {
-  name.trim();
-  if (name.length() == 0)
-    return -1;
+// Copies a preset name argument into out[16]: quotes removed, trimmed,
+// cut to the 15 characters that fit in WindingPreset.name.
+void copyPresetName(const char *arg, char *out) {
+  uint8_t n = 0;
+  for (; *arg && n < 15; arg++) {
+    if (*arg != '"')
+      out[n++] = *arg;
+  }
+  out[n] = 0;
+  char *trimmed = trimChar(out);
+  if (trimmed != out)
+    memmove(out, trimmed, strlen(trimmed) + 1);
+}
 
-  // Konwertujemy szukaną nazwę na tymczasowy bufor char, by uniknąć Stringów w
-  // pętli
-  char searchBuf[16];
-  name.toCharArray(searchBuf, 16);
+// --- PRESET DIRECTORY ---
+
+int presetAddress(int index) {
+  return EEPROM_PRESET_START + (index * sizeof(WindingPreset));
+}
+
+uint8_t presetNameHash(const char *name) {
+  uint8_t h = 0;
+  while (*name)
+    h = ((h << 3) | (h >> 5)) ^ (uint8_t)*name++;
+  return h;
+}
+
+bool isPresetSlotUsed(int index) {
+  return EEPROM.read(EEPROM_DIR_BITMAP + index / 8) & (1 << (index % 8));
+}
+
+void setPresetSlot(int index, bool used, uint8_t hash) {
+  uint8_t bits = EEPROM.read(EEPROM_DIR_BITMAP + index / 8);
+  if (used) {
+    EEPROM.update(EEPROM_DIR_HASHES + index, hash);
+    bits |= 1 << (index % 8);
+  } else {
+    bits &= ~(1 << (index % 8));
+  }
+  EEPROM.update(EEPROM_DIR_BITMAP + index / 8, bits);
+}
+
+// Builds the directory once from the old layout (a gap-free list of slots
+// ending at the first empty name), so existing presets survive the upgrade.
+void initPresetDirectory() {
+  if (EEPROM.read(EEPROM_DIR_ADDR) == PRESET_DIR_MAGIC)
+    return;
+
+  warnDroppedLegacyPresets();
+
+  for (int i = 0; i < PRESET_BITMAP_BYTES; i++)
+    EEPROM.update(EEPROM_DIR_BITMAP + i, 0);
 
   WindingPreset p;
   for (int i = 0; i < MAX_PRESETS; i++) {
-    EEPROM.get(EEPROM_PRESET_START + (i * sizeof(WindingPreset)), p);
-
-    // Jeśli slot jest całkowicie pusty (0 lub 255) - koniec listy (brak dziur)
+    EEPROM.get(presetAddress(i), p);
     if (p.name[0] == 0 || (uint8_t)p.name[0] == 255)
       break;
+    p.name[sizeof(p.name) - 1] = 0;
+    setPresetSlot(i, true, presetNameHash(p.name));
+  }
+  EEPROM.update(EEPROM_DIR_ADDR, PRESET_DIR_MAGIC);
+}
+
+// Old firmware kept up to LEGACY_MAX_PRESETS presets; slots from MAX_PRESETS
+// on are overwritten by the directory and the journal. The old list has no
+// gaps, so those slots are only in use when 0..MAX_PRESETS-1 are all full and
+// there is nowhere to move them: print them as CSV so they can be re-entered.
+void warnDroppedLegacyPresets() {
+  WindingPreset p;
+  for (int i = 0; i < LEGACY_MAX_PRESETS; i++) {
+    EEPROM.get(presetAddress(i), p);
+    if (p.name[0] == 0 || (uint8_t)p.name[0] == 255)
+      return;
+    if (i < MAX_PRESETS)
+      continue;
+    p.name[sizeof(p.name) - 1] = 0;
+    Serial.print(F("WARNING: No room for preset, dropped: "));
+    printPresetCSV(p);
+  }
+}
+
+int findPresetIndex(const char *name) {
+  char searchBuf[16];
+  copyPresetName(name, searchBuf);
+  if (searchBuf[0] == 0)
+    return -1;
 
-    // Porównujemy surowe tablice znaków - najpewniejsza metoda w C
-    if (strcmp(p.name, searchBuf) == 0) {
+  uint8_t hash = presetNameHash(searchBuf);
+  char slotName[16];
+  for (int i = 0; i < MAX_PRESETS; i++) {
+    if (EEPROM.read(EEPROM_DIR_HASHES + i) != hash || !isPresetSlotUsed(i))
+      continue;
+    // Hash match: only now read the name (first field of the preset)
+    EEPROM.get(presetAddress(i), slotName);
+    slotName[sizeof(slotName) - 1] = 0;
+    if (strcmp(slotName, searchBuf) == 0)
       return i;
-    }
   }
   return -1;
 }
 
 int findFirstEmptyPresetSlot() {
-  WindingPreset p;
   for (int i = 0; i < MAX_PRESETS; i++) {
-    int addr = EEPROM_PRESET_START + (i * sizeof(WindingPreset));
-    EEPROM.get(addr, p);
-    // If first character is null, the slot is empty
-    if (p.name[0] == 0 || (uint8_t)p.name[0] == 255)
+    if (!isPresetSlotUsed(i))
       return i;
   }
   return -1; // EEPROM is full
@@ -124,30 +290,33 @@ void exportCSV() {
   Serial.println(F("name,wire,width,turns,rpm,ramp,offset"));
   WindingPreset p;
   for (int i = 0; i < MAX_PRESETS; i++) {
-    EEPROM.get(EEPROM_PRESET_START + (i * sizeof(WindingPreset)), p);
-    if (p.name[0] == 0 || (uint8_t)p.name[0] == 255)
-      break;
-
-    Serial.print(p.name);
-    Serial.print(',');
-    Serial.print(p.wireDia, 3);
-    Serial.print(',');
-    Serial.print(p.coilWidth, 2);
-    Serial.print(',');
-    Serial.print(p.totalTurns);
-    Serial.print(',');
-    Serial.print(p.targetRPM);
-    Serial.print(',');
-    Serial.print(p.rampRPM);
-    Serial.print(',');
-    Serial.println(p.startOffset);
+    if (!isPresetSlotUsed(i))
+      continue;
+    EEPROM.get(presetAddress(i), p);
+    printPresetCSV(p);
   }
   Serial.println(F("--- CSV EXPORT END ---"));
 }
 
-bool loadPresetByName(String name) {
-  name.replace("\"", ""); // Usuń ewentualne cudzysłowy
-  name.trim();
+void printPresetCSV(const WindingPreset &p) {
+  Serial.print(p.name);
+  Serial.print(',');
+  Serial.print(p.wireDia, 3);
+  Serial.print(',');
+  Serial.print(p.coilWidth, 2);
+  Serial.print(',');
+  Serial.print(p.totalTurns);
+  Serial.print(',');
+  Serial.print(p.targetRPM);
+  Serial.print(',');
+  Serial.print(p.rampRPM);
+  Serial.print(',');
+  Serial.println(p.startOffset);
+}
+
+bool loadPresetByName(const char *arg) {
+  char name[16];
+  copyPresetName(arg, name); // Usuń ewentualne cudzysłowy
 
   int index = findPresetIndex(name);
   if (index == -1) {
@@ -158,7 +327,7 @@ bool loadPresetByName(String name) {
   };
 
   // Wczytaj dane z EEPROM bezpośrednio do zmiennej globalnej 'active'
-  EEPROM.get(EEPROM_PRESET_START + (index * sizeof(WindingPreset)), active);
+  EEPROM.get(presetAddress(index), active);
 
   Serial.print(F("SYSTEM: Loaded preset '"));
   Serial.print(active.name);
@@ -166,7 +335,7 @@ bool loadPresetByName(String name) {
 
   // Po załadowaniu warto wyświetlić parametry, żeby użytkownik widział co
   // wczytał
-  handleGet(F("PRESET"));
+  handleGet("PRESET");
   return true;
 }
 
@@ -183,31 +352,21 @@ char *trimChar(char *str) {
   return str;
 }
 
-bool savePreset(String cmd) {
-  cmd.trim();
-
-  // 1. Oczyszczenie komendy z przedrostka "SAVE"
-  if (cmd.startsWith("SAVE")) {
-    cmd = cmd.substring(4);
-    cmd.trim();
-  }
+bool savePreset(char *cmd) {
+  cmd = trimChar(cmd);
 
   // Tworzymy NOWY obiekt zamiast kopii active, żeby nie dziedziczyć błędnych
   // nazw
   WindingPreset pToSave;
   memset(&pToSave, 0, sizeof(WindingPreset));
 
-  if (cmd.length() > 0) {
-    if (cmd.indexOf(',') != -1) {
-      // SCENARIUSZ 1: IMPORT CSV
-      char buf[128];
-      cmd.toCharArray(buf, sizeof(buf));
-      char *token = strtok(buf, ",");
+  if (*cmd != 0) {
+    if (strchr(cmd, ',') != NULL) {
+      // SCENARIUSZ 1: IMPORT CSV (tniemy bufor komendy w miejscu)
+      char *token = strtok(cmd, ",");
 
       if (token) {
-        String n = String(token);
-        n.trim();
-        n.toCharArray(pToSave.name, sizeof(pToSave.name));
+        strncpy(pToSave.name, trimChar(token), sizeof(pToSave.name) - 1);
       }
 
       // Wczytujemy resztę wartości do pToSave
@@ -230,7 +389,7 @@ bool savePreset(String cmd) {
     } else {
       // SCENARIUSZ 2: SAVE NowaNazwa
       // Nazwa to po prostu trimowany cmd
-      cmd.toCharArray(pToSave.name, sizeof(pToSave.name));
+      strncpy(pToSave.name, cmd, sizeof(pToSave.name) - 1);
 
       // Kopiujemy resztę wartości z active
       pToSave.wireDia = active.wireDia;
@@ -256,7 +415,9 @@ bool savePreset(String cmd) {
     index = findFirstEmptyPresetSlot();
 
   if (index != -1) {
-    EEPROM.put(EEPROM_PRESET_START + (index * sizeof(WindingPreset)), pToSave);
+    // Data first, then the directory: a reset in between loses nothing
+    EEPROM.put(presetAddress(index), pToSave);
+    setPresetSlot(index, true, presetNameHash(pToSave.name));
     Serial.print(F("SYSTEM: Preset '"));
     Serial.print(pToSave.name);
     Serial.print(F("' saved to slot "));
@@ -266,9 +427,9 @@ bool savePreset(String cmd) {
   return false;
 }
 
-void deletePreset(String name) {
-  name.replace("\"", ""); // Usuń ewentualne cudzysłowy
-  name.trim();
+void deletePreset(const char *arg) {
+  char name[16];
+  copyPresetName(arg, name); // Usuń ewentualne cudzysłowy
 
   int index = findPresetIndex(name);
   if (index == -1) {
@@ -276,38 +437,15 @@ void deletePreset(String name) {
     return;
   }
 
-  WindingPreset nextPreset;
-  int i;
-
-  // Przesuwanie presetów w górę
-  for (i = index; i < MAX_PRESETS - 1; i++) {
-    // Pobierz następny preset
-    EEPROM.get(EEPROM_PRESET_START + ((i + 1) * sizeof(WindingPreset)),
-               nextPreset);
-
-    // Zapisz go w miejsce aktualnego (usuwanego/przesuwanego)
-    EEPROM.put(EEPROM_PRESET_START + (i * sizeof(WindingPreset)), nextPreset);
-
-    // Jeśli trafiliśmy na pusty slot (koniec listy), możemy przerwać wcześniej
-    if (nextPreset.name[0] == 0)
-      break;
-  }
-
-  // Wyczyszczenie ostatniego slotu, aby uniknąć "duplikatu" na końcu listy
-  WindingPreset empty;
-  memset(&empty, 0, sizeof(WindingPreset));
-  EEPROM.put(EEPROM_PRESET_START + (i * sizeof(WindingPreset)), empty);
+  setPresetSlot(index, false, 0);
 
   Serial.print(F("SYSTEM: Preset '"));
   Serial.print(name);
-  Serial.println(F("' deleted and EEPROM compacted."));
+  Serial.println(F("' deleted."));
 }
 
 void formatPresets() {
-  WindingPreset empty;
-  memset(&empty, 0, sizeof(WindingPreset));
-  for (int i = 0; i < MAX_PRESETS; i++) {
-    EEPROM.put(EEPROM_PRESET_START + (i * sizeof(WindingPreset)), empty);
-  }
+  for (int i = 0; i < PRESET_BITMAP_BYTES; i++)
+    EEPROM.update(EEPROM_DIR_BITMAP + i, 0);
   Serial.println(F("SYSTEM: EEPROM Presets wiped."));
 }
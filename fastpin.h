@@ -0,0 +1,43 @@
+#ifndef FASTPIN_H
+#define FASTPIN_H
+
+// --- COMPILE-TIME PIN ACCESS ---
+// FastPin<pin> resolves an Arduino pin number to its PORT/PIN register and bit
+// at compile time, so write()/read() become single sbi/cbi/sbic instructions
+// instead of a digitalWrite() table lookup. Safe to use from the step ISR.
+//
+// Nano (ATmega328P): D0-D7 -> PORTD, D8-D13 -> PORTB, A0-A5 (14-19) -> PORTC.
+// On anything else we fall back to digitalWrite()/digitalRead().
+
+template <uint8_t pin> struct FastPin {
+  static_assert(pin < 20, "FastPin: pin does not exist on the Nano");
+
+#if defined(__AVR_ATmega328P__)
+  static inline volatile uint8_t &port() __attribute__((always_inline)) {
+    return pin < 8 ? PORTD : (pin < 14 ? PORTB : PORTC);
+  }
+  static inline volatile uint8_t &in() __attribute__((always_inline)) {
+    return pin < 8 ? PIND : (pin < 14 ? PINB : PINC);
+  }
+  static inline uint8_t mask() __attribute__((always_inline)) {
+    return _BV(pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+  }
+
+  static inline void high() __attribute__((always_inline)) { port() |= mask(); }
+  static inline void low() __attribute__((always_inline)) { port() &= ~mask(); }
+  static inline bool read() __attribute__((always_inline)) { return in() & mask(); }
+#else
+  static inline void high() { digitalWrite(pin, HIGH); }
+  static inline void low() { digitalWrite(pin, LOW); }
+  static inline bool read() { return digitalRead(pin) == HIGH; }
+#endif
+
+  static inline void write(bool level) {
+    if (level)
+      high();
+    else
+      low();
+  }
+};
+
+#endif // FASTPIN_H
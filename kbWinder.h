@@ -7,6 +7,8 @@
 #include <EEPROM.h>
 #include <SoftwareSerial.h>
 
+#include "fastpin.h"
+
 // --- HARDWARE PINS ---
 #define W_STEP 17
 #define W_DIR 16
@@ -15,6 +17,13 @@
 #define EN 12
 #define LIMIT_PIN 4
 
+typedef FastPin<W_STEP> WStepPin;
+typedef FastPin<W_DIR> WDirPin;
+typedef FastPin<T_STEP> TStepPin;
+typedef FastPin<T_DIR> TDirPin;
+typedef FastPin<EN> EnablePin;
+typedef FastPin<LIMIT_PIN> LimitPin;
+
 enum MachineState { IDLE,
                     RUNNING,
                     PAUSED,
@@ -30,11 +39,21 @@ float stepsPerMM;
 long absPos = 0;  // Traverse steps from 0
 bool isHomed = false;
 int homingPhase = 0;  // 0: searching switch, 1: backing off
+unsigned long jogLastPinged = 0; // only one JOG runs at a time
 
-unsigned long lastStepMicros = 0;
-float traverseAccumulator = 0;
+long traverseAccumulator = 0;  // Bresenham error term, 0..traverseDen-1
 long currentLayerSteps = 0;
 int layerDir = 1;
+uint16_t layerCount = 0;       // layers finished since START
+long traverseNum = 0;         // T steps per W step = traverseNum / traverseDen
+long traverseDen = 1;
+long stepsInLayer = 0;        // T steps across one layer
+long nextProgressReport = 0;  // winder step count of the next progress line
+
+// Last level written to the DIR pins (DIR_UNKNOWN forces the next write)
+#define DIR_UNKNOWN 0xFF
+uint8_t wDirLevel = DIR_UNKNOWN;
+uint8_t tDirLevel = DIR_UNKNOWN;
 
 // to było:
 long currentStepsW = 0;  // Winder progress in steps
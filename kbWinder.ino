@@ -2,8 +2,11 @@ const char version[4] = "1.0\0";
 
 #include "eeprom.h"
 #include "kbWinder.h"
+#include "perf.h"
 #include "serial.h"
 #include "taskqueue.h"
+#include "stepper.h"
+#include "telemetry.h"
 #include "variables.h"
 
 // SoftwareSerial nextionSerial(2, 3);
@@ -19,6 +22,18 @@ void updateDerivedValues() {
   }
 }
 
+long gcd(long a, long b) {
+  while (b != 0) {
+    long r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+// mm (float) -> um (long), used to turn the gearing into exact integers
+long mmToMicrons(float mm) { return (long)(mm * 1000.0 + 0.5); }
+
 long rpmToDelay(int rpm) {
   if (rpm < 10)
     rpm = 10;
@@ -27,14 +42,12 @@ long rpmToDelay(int rpm) {
 
 // --- CORE FUNCTIONS: START ---
 
-void parseStartCommand(String params) {
-  params.trim();
-
+void parseStartCommand(char *params) {
   // if empty - we're using current 'active' parameters.
-  if (params.length() == 0) {
+  if (*params == 0) {
     initiateWinding();
     return;
-  } else if (params.startsWith("\"") || !isdigit(params[0])) {
+  } else if (params[0] == '"' || !isdigit(params[0])) {
     // Parameter is a preset name (in quotes or just text)
     if (loadPresetByName(params))
       initiateWinding();
@@ -45,19 +58,13 @@ void parseStartCommand(String params) {
   }
 }
 
-bool parseStartCommandNumericValues(String params) {
-  // Jeśli to liczby, parsujemy pozycje spacji
+bool parseStartCommandNumericValues(char *params) {
+  // Jeśli to liczby, tniemy po spacjach
   float vals[6];
   int count = 0;
-  int pos = 0;
-  while (pos < params.length() && count < 6) {
-    int nextSpace = params.indexOf(' ', pos);
-    String part = (nextSpace == -1) ? params.substring(pos)
-                                    : params.substring(pos, nextSpace);
-    vals[count++] = part.toFloat();
-    if (nextSpace == -1)
-      break;
-    pos = nextSpace + 1;
+  char *token;
+  while (count < 6 && (token = nextToken(&params)) != NULL) {
+    vals[count++] = atof(token);
   }
 
   if (count < 3) {
@@ -120,7 +127,7 @@ void initiateWinding() {
   Serial.println(F("MSG: Winding sequence enqueued."));
 
   // 6. Aktywacja silników i zmiana stanu
-  digitalWrite(EN, LOW); // Prąd na silniki
+  EnablePin::low(); // Prąd na silniki
   printStatus();
 }
 
@@ -167,64 +174,62 @@ void resumeTask() {
   // Przywracamy stan sprzed pauzy (HOMING, MOVING lub RUNNING)
   t->state = t->prevState;
 
-  t->currentRPM = t->startRPM;
+  t->currentRPM = RPM_Q(t->startRPM);
+  t->rampAccel = 0;
+  t->rampBrake = 0;
+  t->rpmFraction = 0;
   t->isDecelerating = false;
   isPauseRequested = false;
+  t->lastRampUpdate = millis(); // no catching up on the paused time
+  planTaskRamp(t);
+  calculateCachedDelay(t);
 
-  digitalWrite(EN, LOW);
-  lastStepMicros = micros();
+  EnablePin::low();
+  // executeMotion() hands the task back to the step engine on the next loop
   Serial.println(F("MSG: Task resumed"));
 }
 
 // --- CORE FUNCTIONS: GOTO HOME, W, T ---
 
-void handleGotoCommand(String cmd) {
+void handleGotoCommand(char *args) {
   // GOTO <position> [speed] lub GOTO HOME [speed]
-  String param = cmd.substring(5);
-  param.trim();
-  int spaceIdx = param.indexOf(' ');
-  String posStr = (spaceIdx == -1) ? param : param.substring(0, spaceIdx);
-  int rpm =
-      (spaceIdx == -1) ? cfg.maxRPM_T : param.substring(spaceIdx + 1).toInt();
-
-  if (posStr == F("START")) {
+  char *posStr = nextToken(&args);
+  char *rpmStr = nextToken(&args);
+  if (posStr == NULL)
+    posStr = args; // ""
+  int rpm = (rpmStr == NULL) ? cfg.maxRPM_T : atoi(rpmStr);
+
+  if (strcmp_P(posStr, PSTR("START")) == 0) {
     // GOTO START goes to active preset start offset
     enqueueTask(MOVING, 'T', active.startOffset * stepsPerMM, false, rpm,
                 cfg.defaultRamp_T, false);
-  } else if (posStr == F("ZERO")) {
+  } else if (strcmp_P(posStr, PSTR("ZERO")) == 0) {
     // GOTO ZERO goes to zero
     enqueueTask(MOVING, 'T', 0, false, rpm, cfg.defaultRamp_T, false);
-  } else if (posStr == F("BACKOFF")) {
+  } else if (strcmp_P(posStr, PSTR("BACKOFF")) == 0) {
     // GOTO BACKOFF goes to backoff distance!
     enqueueTask(MOVING, 'T', cfg.backoffDistanceMM * stepsPerMM, false, rpm,
                 cfg.defaultRamp_T, false);
   } else {
     // GOTO <absPos>
-    long targetPosInSteps = (long)(posStr.toFloat() * stepsPerMM);
+    long targetPosInSteps = (long)(atof(posStr) * stepsPerMM);
     enqueueTask(MOVING, 'T', targetPosInSteps, false, rpm, cfg.defaultRamp_T,
                 false);
   }
 }
 
-void moveManual(String cmd) { moveManual(cmd, false); }
-
-void moveManual(String cmd, bool isJogMove) {
-  char motor = cmd[0]; // 'W' lub 'T'
-  String param = cmd.substring(2);
-  param.trim();
-  float val;
+// motor: 'W' lub 'T', args: <distance> [speed]
+void moveManual(char motor, char *args, bool isJogMove) {
+  char *valStr = nextToken(&args);
+  char *rpmStr = nextToken(&args);
+  float val = (valStr == NULL) ? 0 : atof(valStr);
   int rpm;
   int ramp;
 
-  int spaceIdx = param.indexOf(' ');
-
-  if (spaceIdx == -1) {
-    // Brak spacji - cała reszta to dystans
-    val = param.toFloat();
+  if (rpmStr == NULL) {
     rpm = (motor == 'W') ? cfg.maxRPM_W : cfg.maxRPM_T; // Domyślne RPM
   } else {
-    val = param.substring(0, spaceIdx).toFloat();
-    rpm = param.substring(spaceIdx + 1).toInt();
+    rpm = atoi(rpmStr);
   }
 
   long steps = 0;
@@ -250,7 +255,8 @@ void setup() {
   pinMode(T_STEP, OUTPUT);
   pinMode(T_DIR, OUTPUT);
   pinMode(LIMIT_PIN, INPUT_PULLUP);
-  digitalWrite(EN, HIGH);
+  EnablePin::high();
+  stepperBegin();
 
   Serial.begin(57600);
   Serial.print(F("\n\n--- kbWinder OS V"));
@@ -266,10 +272,11 @@ void setup() {
 }
 
 void loop() {
-  if (Serial.available()) {
-    processCommand(Serial.readStringUntil('\n'));
-  }
+  perfTrackLoop();
+  pollSerial(); // never waits for a whole line
   executeMotion(getCurrentTask());
+  telemetryPoll();
+  configPoll();
 }
 
 // --- CORE FUNCTIONS: SEEK ZERO ---
@@ -304,13 +311,10 @@ void initiateHoming(int speed) {
   Serial.println(F(" RPM..."));
 }
 
-void parseSeekZeroCommand(String cmd) {
-  String speedPart = cmd.substring(9);
-  speedPart.trim();
-
+void parseSeekZeroCommand(char *args) {
   int rpm;
-  if (speedPart.length() > 0) {
-    rpm = speedPart.toInt();
+  if (*args != 0) {
+    rpm = atoi(args);
   } else {
     // If no speed given, use max or slow speed based on switch config
     rpm = cfg.useLimitSwitch ? cfg.maxRPM_T
@@ -321,46 +325,191 @@ void parseSeekZeroCommand(String cmd) {
 
 // --- HANDLE ACTUAL TASK OPERATIONS ---
 // startTask(), executeMotion(), stepActiveMotor(), updateTaskRamp()
+// The pulses themselves come from the Timer1 ISR (stepper.ino); everything
+// here runs in loop() and only feeds the engine the task and its delay.
 
 void startTask(Task *t) {
   if (t->isStarted)
     return;
 
-  traverseAccumulator = 0.0;
+  traverseAccumulator = 0;
   currentLayerSteps = 0;
+  nextProgressReport = (long)cfg.stepsPerRevW * 10;
+
+  if (t->state == RUNNING) {
+    layerCount = 0;
+    // Synchronizacja (Bresenham) - liczone raz, nie w przerwaniu.
+    // T/W = (wire / pitch) * (stepsPerRevT / stepsPerRevW), as an exact
+    // fraction of micrometres and steps, so nothing drifts on long coils.
+    long wireUm = mmToMicrons(active.wireDia);
+    long pitchUm = mmToMicrons(cfg.screwPitch);
+    if (pitchUm <= 0)
+      pitchUm = 1000;
+    traverseNum = wireUm * cfg.stepsPerRevT;
+    traverseDen = pitchUm * cfg.stepsPerRevW;
+    long div = gcd(traverseNum, traverseDen);
+    if (div > 1) {
+      traverseNum /= div;
+      traverseDen /= div;
+    }
+    stepsInLayer = mmToMicrons(active.coilWidth) * cfg.stepsPerRevT / pitchUm;
+  }
+
+  prepareTask(t, stepperReadPosition(), 0);
+  EnablePin::low(); // Prąd na silniki
+  Serial.println(F("Task started."));
+  printStatus();
+}
 
+// Resolves target/direction from the given start position and RPM_Q() speed
+// (0 = from standstill) and precomputes the ramp. Also used to get the next task
+// ready while the current one is still running (see chainNextTask()), so it
+// must not touch the engine.
+void prepareTask(Task *t, long fromPos, uint32_t fromRPM) {
   if (t->isRelative) {
     t->targetPosition =
-        absPos + (t->dir == 1 ? t->targetSteps : -t->targetSteps);
+        fromPos + (t->dir == 1 ? t->targetSteps : -t->targetSteps);
     // t->dir already set
   } else {
-    long diff = t->targetPosition - absPos;
+    long diff = t->targetPosition - fromPos;
     t->targetSteps = abs(diff);
     t->dir = (diff >= 0) ? 1 : -1;
   }
-  t->currentRPM = t->startRPM;
-
-  t->taskStarted = millis();
-  t->taskLastPinged = t->taskStarted;
-  t->lastRampUpdate = t->taskStarted;
+  t->currentRPM = max(RPM_Q(t->startRPM), min(fromRPM, RPM_Q(t->targetRPM)));
+
+  // Jedyne dzielenia rampy - raz na zadanie
+  bool winder = isWinderTask(t);
+  int spr = winder ? cfg.stepsPerRevW : cfg.stepsPerRevT;
+  t->delayNumerator = (STEPPER_TICKS_PER_MIN / spr) << RPM_SHIFT;
+  t->rampStep = RPM_Q(t->accelRate) / (1000 / RAMP_TICK_MS);
+
+  // S-curve: full acceleration is reached in a whole number of jerk steps
+  int jerk = winder ? cfg.jerk_W : cfg.jerk_T;
+  t->jerkStep = 0;
+  t->accelMax = (uint32_t)t->rampStep << ACCEL_SHIFT;
+  if (jerk > 0 && t->rampStep > 0) {
+    long ticks = (long)t->accelRate * (1000 / RAMP_TICK_MS) / jerk;
+    ticks = constrain(ticks, 1, JERK_MAX_TICKS);
+    t->jerkStep = t->accelMax / ticks;
+    t->accelMax = t->jerkStep * ticks;
+  }
+  t->rampAccel = 0;
+  t->rampBrake = 0;
+  t->rpmFraction = 0;
+  planTaskRamp(t);
+
+  t->lastRampUpdate = millis();
+  if (t->isJogMove)
+    jogLastPinged = t->lastRampUpdate;
   calculateCachedDelay(t);
-  digitalWrite(EN, LOW); // Prąd na silniki
   t->isStarted = true;
-  Serial.println(F("Task started."));
-  printStatus();
-  lastStepMicros = micros();
 }
 
+// Winding runs on the winder's ramp, everything else on the traverse's
+bool isWinderTask(const Task *t) {
+  return t->state == RUNNING || t->motor == 'W';
+}
+
+// Steps a ramp between two speeds takes at accel RPM/s. An S-curve ramp
+// (jerkTime s to reach full acceleration) takes jerkTime longer, or never
+// reaches full acceleration when the speed change is small.
+float rampSteps(float fromRPM, float toRPM, float accel, float jerkTime,
+                int spr) {
+  float dv = fabs(toRPM - fromRPM);
+  float time = (dv >= accel * jerkTime) ? dv / accel + jerkTime
+                                        : 2 * sqrt(dv * jerkTime / accel);
+  return (fromRPM + toRPM) * time * spr / 120.0; // average speed * time
+}
+
+// Closed-form ramp plan from the current speed and the steps left: where
+// braking to the exit speed has to start (decelSteps before the target), so
+// the move lands on it instead of crawling there or arriving fast. A move
+// too short to reach targetRPM gets a triangle profile: targetRPM is
+// lowered to its peak, so the accelerating side eases into it as well.
+// Floats, but only once per task (and when the plan changes).
+void planTaskRamp(Task *t) {
+  t->decelSteps = 0;
+  long steps = t->targetSteps - stepperReadSteps(t);
+  if (t->rampStep == 0 || steps <= 0)
+    return;
+
+  // The acceleration the ramp really runs at, after integer rounding
+  int spr = isWinderTask(t) ? cfg.stepsPerRevW : cfg.stepsPerRevT;
+  float accel = RPM_TO_FLOAT(t->accelMax) / (1 << ACCEL_SHIFT) *
+                (1000 / RAMP_TICK_MS);
+  float jerkTime = 0;
+  if (t->jerkStep != 0)
+    jerkTime = (float)(t->accelMax / t->jerkStep) * RAMP_TICK_MS / 1000.0;
+
+  float v0 = RPM_TO_FLOAT(t->currentRPM);
+  float vc = max(v0, (float)t->targetRPM);
+  float ve = min(vc, (float)max(t->startRPM, t->exitRPM));
+
+  float decel = rampSteps(vc, ve, accel, jerkTime, spr);
+  if (rampSteps(v0, vc, accel, jerkTime, spr) + decel > steps) {
+    // Triangle: the peak both ramps fit under. Linear ramps take
+    // spr / (120 * accel) steps per RPM^2, S-curves are bisected.
+    float lo = max(v0, ve);
+    if (jerkTime == 0) {
+      float peak2 = (steps * 120.0 * accel / spr + v0 * v0 + ve * ve) / 2;
+      lo = max(lo, sqrt(peak2));
+    } else {
+      float hi = vc;
+      for (int i = 0; i < 16; i++) {
+        float vp = (lo + hi) / 2;
+        if (rampSteps(v0, vp, accel, jerkTime, spr) +
+                rampSteps(vp, ve, accel, jerkTime, spr) >
+            steps)
+          hi = vp;
+        else
+          lo = vp;
+      }
+    }
+    decel = rampSteps(lo, ve, accel, jerkTime, spr);
+    t->targetRPM = (uint16_t)lo; // whole RPM, rounded down
+  }
+  t->decelSteps = min((long)decel, steps);
+}
+
+// Hands the next queued task to the step engine ahead of time when the
+// planner decided to blend into it, so the ISR moves on without stopping.
+// Only the same motor going the same way is blended; if the planner's guess
+// turns out wrong, this task stops as usual instead.
+void chainNextTask(Task *t) {
+  Task *next = getNextTask();
+  if (t->exitRPM == 0 || next == NULL || next->isStarted ||
+      stepperNextTask != NULL)
+    return;
+
+  if (next->motor == t->motor) {
+    prepareTask(next, t->targetPosition, RPM_Q(t->exitRPM));
+    if (next->dir == t->dir) {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { stepperNextTask = next; }
+      return;
+    }
+    next->isStarted = false; // startTask() prepares it again later
+  }
+  t->exitRPM = 0;
+  planTaskRamp(t);
+}
+
+// One integer division per ramp tick; delayNumerator comes from startTask().
+// Only the task owned by the engine (or none) may change the step rate.
 void calculateCachedDelay(Task *t) {
-  int spr = (t->state == RUNNING || t->motor == 'W') ? cfg.stepsPerRevW
-                                                     : cfg.stepsPerRevT;
-  t->cachedDelay = 60000000L / ((unsigned long)t->currentRPM * spr);
+  unsigned long ticks = STEPPER_MAX_TICKS;
+  if (t->currentRPM != 0)
+    ticks = t->delayNumerator / t->currentRPM;
+  t->cachedDelay = min(ticks, (unsigned long)STEPPER_MAX_TICKS);
+  if (stepperTask == t || stepperTask == NULL)
+    stepperSetTicks(t->cachedDelay);
 }
 
 void executeMotion(Task *t) {
   if (t == NULL || t->state == IDLE || t->state == PAUSED ||
       t->state == ERROR) { // IDLE
-    digitalWrite(EN, HIGH);
+    if (stepperTask != NULL)
+      stepperStop();
+    EnablePin::high();
     return;
   }
   // case RUNNING, MOVING, HOMING:
@@ -370,31 +519,35 @@ void executeMotion(Task *t) {
   }
 
   handlePause(t);
+  if (t->state == PAUSED)
+    return;
 
-  if (t->isJogMove && (millis() - t->taskLastPinged > 2000)) {
+  if (t->isJogMove && (millis() - jogLastPinged > 2000)) {
     t->state = ERROR;
     Serial.println(F("ALARM: Jog timeout! Connection lost?"));
   } else {
+    // Limit switch hit while driving towards it (outside of homing)
+    if (stepperHalted && t->state != HOMING) {
+      emergencyStop(false);
+      return;
+    }
 
-    unsigned long now = micros();
-
-    if (now - lastStepMicros >= t->cachedDelay) {
-      lastStepMicros += t->cachedDelay;
-      // lastStepMicros = now;
-
-      stepActiveMotor(t);
-      t->currentSteps++;
+    if (stepperTask == NULL)
+      stepperStart(t); // new task or resumed after PAUSE
+    chainNextTask(t);
 
-      printIfWinderJustFinished10Revs(t);
-      updateTaskRamp(t);
+    printLayerFlip(t);
+    printIfWinderJustFinished10Revs(t);
+    updateTaskRamp(t);
 
-      handleHomingLogic(t);
-      handleTaskEnd(t);
-    }
+    handleHomingLogic(t);
+    handleTaskEnd(t);
   }
   if (t->state == ERROR) {
+    telemetryEvent(TLM_EV_ERROR);
     Serial.println(F("ERROR encountered. Stopping motors, clearing queue."));
-    digitalWrite(EN, HIGH);
+    stepperStop();
+    EnablePin::high();
     clearQueue();
   }
 }
@@ -403,15 +556,28 @@ void printIfWinderJustFinished10Revs(Task *t) {
   // Logujemy tylko gdy kręci się winder (tryb RUNNING lub zadanie dla silnika
   // 'W')
   if (t->state == RUNNING || t->motor == 'W') {
-    long stepsPer10Rev = (long)cfg.stepsPerRevW * 10;
-    if (t->currentSteps > 0 && t->currentSteps % stepsPer10Rev == 0) {
-      long currentTurns = t->currentSteps / cfg.stepsPerRevW;
-      printCurrentProgress("Progress", currentTurns, active.totalTurns);
+    // The ISR may run several steps per loop, so compare against a threshold
+    // instead of waiting for an exact multiple of 10 revs.
+    long steps = stepperReadSteps(t);
+    if (steps >= nextProgressReport) {
+      nextProgressReport += (long)cfg.stepsPerRevW * 10;
+      long currentTurns = steps / cfg.stepsPerRevW;
+      printCurrentProgress(F("Progress"), currentTurns, active.totalTurns);
     }
   }
 }
 
-void printCurrentProgress(String msg, float currentTurns, int totalTurns) {
+void printLayerFlip(Task *t) {
+  if (!stepperLayerFlipped)
+    return;
+  stepperLayerFlipped = false;
+  telemetryEvent(TLM_EV_LAYER_FLIP);
+  float currentTurns = (float)stepperReadSteps(t) / cfg.stepsPerRevW;
+  printCurrentProgress(F("Layer Flip"), currentTurns, active.totalTurns);
+}
+
+void printCurrentProgress(const __FlashStringHelper *msg, float currentTurns,
+                          int totalTurns) {
   Serial.print(F("MSG: "));
   Serial.print(msg);
   Serial.print(F(" ("));
@@ -423,96 +589,100 @@ void printCurrentProgress(String msg, float currentTurns, int totalTurns) {
 
 void handlePause(Task *t) {
   // Jeśli trwa hamowanie do pauzy i osiągnęliśmy prędkość minimalną
-  if (isPauseRequested && t->currentRPM <= t->startRPM) {
+  if (isPauseRequested && t->currentRPM <= RPM_Q(t->startRPM)) {
     t->prevState = t->state; // Zapamiętaj czy to był RUNNING, MOVING czy HOMING
     t->state = PAUSED;
     isPauseRequested = false;
-    digitalWrite(EN, HIGH); // Odłącz prąd (bezpieczeństwo i chłodzenie)
+    stepperStop();
+    EnablePin::high(); // Odłącz prąd (bezpieczeństwo i chłodzenie)
     Serial.println(F("MSG: Status set to PAUSED"));
     return;
   }
 }
 
+// DIR pins are only rewritten when the level changes. Returns true if it
+// did, so the caller can give the driver its direction setup time.
+inline bool setWinderDir(bool level) {
+  if (wDirLevel == level)
+    return false;
+  wDirLevel = level;
+  WDirPin::write(level);
+  return true;
+}
+
+inline bool setTraverseDir(bool level) {
+  if (tDirLevel == level)
+    return false;
+  tDirLevel = level;
+  TDirPin::write(level);
+  return true;
+}
+
+// Called from the Timer1 ISR only: no Serial, no blocking calls. Anything
+// worth reporting is flagged in stepperLayerFlipped / stepperHalted.
 void stepActiveMotor(Task *t) {
   if (t->state == RUNNING) {
     // --- SYNCHRONIZED WINDING (Master: Winder, Slave: Traverse) ---
-    digitalWrite(W_DIR, cfg.dirW ? HIGH : LOW);
-    digitalWrite(W_STEP, HIGH);
+    if (setWinderDir(cfg.dirW))
+      delayMicroseconds(1);
+    WStepPin::high();
 
-    // Synchronizacja (Bresenham)
-    float ratio = (active.wireDia / cfg.screwPitch) *
-                  ((float)cfg.stepsPerRevT / cfg.stepsPerRevW);
-    traverseAccumulator += ratio;
+    // Synchronizacja (Bresenham), traverseNum/Den policzone w startTask()
+    traverseAccumulator += traverseNum;
 
     // WHILE instead of IF handles wires thicker than screw pitch step
     // equivalent
-    while (traverseAccumulator >= 1.0) {
-      digitalWrite(T_DIR, (layerDir == 1) ? cfg.dirT : !cfg.dirT);
-      digitalWrite(T_STEP, HIGH);
+    while (traverseAccumulator >= traverseDen) {
+      if (setTraverseDir((layerDir == 1) ? cfg.dirT : !cfg.dirT))
+        delayMicroseconds(1);
+      TStepPin::high();
       delayMicroseconds(2); // Small pulse for T driver
-      digitalWrite(T_STEP, LOW);
+      TStepPin::low();
 
       absPos += (layerDir == 1) ? 1 : -1;
-      traverseAccumulator -= 1.0;
+      traverseAccumulator -= traverseDen;
       currentLayerSteps++;
     }
 
-    // Layer Flip Logic
-    long stepsInLayer =
-        (long)(active.coilWidth * ((float)cfg.stepsPerRevT / cfg.screwPitch));
-
+    // Layer Flip Logic (printed later by printLayerFlip())
     if (currentLayerSteps >= stepsInLayer) {
       layerDir *= -1;
       currentLayerSteps = 0;
-      float currentTurns = (float)t->currentSteps / cfg.stepsPerRevW;
-      printCurrentProgress("Layer Flip", currentTurns, active.totalTurns);
+      layerCount++;
+      stepperLayerFlipped = true;
     }
-    digitalWrite(W_STEP, LOW);
+    WStepPin::low();
+  } else if (t->motor == 'W') {
+    // --- SINGLE MOTOR MOVE: Winder ---
+    if (setWinderDir((t->dir == 1) ? cfg.dirW : !cfg.dirW))
+      delayMicroseconds(1);
+    WStepPin::high();
+    delayMicroseconds(2);
+    WStepPin::low();
   } else {
-    // --- SINGLE MOTOR MOVE (T or W or Homing) ---
-    // Najpierw ustal kierunek dla ruchów innych niż Homing (bo ten ma
-    // kierunek ustalony w initiateHoming)
-    if (t->state == MOVING) {
-      if (t->motor == 'T') {
-        // Tu logika dla GOTO lub relatywnego T (ustalenie DIR przed krokiem)
-        // To zazwyczaj dzieje się w executeMotion lub przed dodaniem do
-        // kolejki
-      }
-    }
-
-    // direction
-    int dirPin = (t->motor == 'W') ? W_DIR : T_DIR;
-    bool dirValue = (t->motor == 'W') ? cfg.dirW : cfg.dirT;
-    digitalWrite(dirPin, (t->dir == 1) ? dirValue : !dirValue);
-
-    // motion (pulse)
-    int sPin = (t->motor == 'W') ? W_STEP : T_STEP;
-    digitalWrite(sPin, HIGH);
+    // --- SINGLE MOTOR MOVE: Traverse (T, GOTO or Homing) ---
+    if (setTraverseDir((t->dir == 1) ? cfg.dirT : !cfg.dirT))
+      delayMicroseconds(1);
+    TStepPin::high();
     delayMicroseconds(2);
-    digitalWrite(sPin, LOW);
+    TStepPin::low();
 
-    if (t->motor == 'T') {
-      absPos += (digitalRead(T_DIR) == cfg.dirT) ? 1 : -1;
+    absPos += (t->dir == 1) ? 1 : -1;
 
-      // Limit switch safety (except during homing phase 0)
-      if (cfg.useLimitSwitch && digitalRead(LIMIT_PIN) == LOW &&
-          t->state != HOMING && digitalRead(T_DIR) == !cfg.dirT) {
-        emergencyStop(false);
-        return;
-      }
+    // Limit switch: stop stepping at once. loop() turns this into an
+    // emergency stop, or into the next homing phase when seeking zero.
+    if (cfg.useLimitSwitch && t->dir == -1 && !LimitPin::read()) {
+      stepperHalted = true;
     }
   }
 }
 
 void updateTaskRamp(Task *t) {
   unsigned long now = millis();
-  if (now - t->lastRampUpdate < 10)
+  if (now - t->lastRampUpdate < RAMP_TICK_MS)
     return; // Aktualizuj rampę co 10ms (100Hz)
 
-  float dt = (now - t->lastRampUpdate) / 1000.0; // Delta czasu w sekundach
-  t->lastRampUpdate = now;
-
-  long stepsRemaining = t->targetSteps - t->currentSteps;
+  long stepsRemaining = t->targetSteps - stepperReadSteps(t);
 
   // Flaga wymuszająca hamowanie: albo żądanie pauzy, albo naturalny koniec
   // rampy
@@ -521,27 +691,78 @@ void updateTaskRamp(Task *t) {
   // Hamujemy przy dojeździe do celu TYLKO jeśli to nie jest faza szukania
   // switcha
   bool arrivalDecel = (t->state != HOMING || homingPhase != 0) &&
-                      (stepsRemaining <= t->accelDistance);
+                      (stepsRemaining <= t->decelSteps);
+
+  // Przy dojeździe hamujemy tylko do prędkości przejścia w następne zadanie
+  uint32_t floorRPM = RPM_Q(t->startRPM);
+  if (!isPauseRequested && t->exitRPM > t->startRPM)
+    floorRPM = RPM_Q(t->exitRPM);
 
-  float rpmStep = t->accelRate * dt; // Ile RPM dodać/odjąć w tym kroku czasowym
+  // Stały krok rampy na każde 10 ms; po dłuższej pętli nadrabiamy zaległe
+  // ticki, więc średnie przyspieszenie się zgadza
+  while (now - t->lastRampUpdate >= RAMP_TICK_MS) {
+    t->lastRampUpdate += RAMP_TICK_MS;
 
-  if (forceDecel || arrivalDecel) {
-    t->isDecelerating = true;
-    if (t->currentRPM > t->startRPM) {
+    if (forceDecel || arrivalDecel) {
+      t->isDecelerating = true;
       // Przy pauzie możemy hamować nieco szybciej (accelRate * 3)
-      t->currentRPM -= (isPauseRequested ? rpmStep * 3 : rpmStep);
-      if (t->currentRPM < t->startRPM)
-        t->currentRPM = t->startRPM;
+      uint32_t rpmStep = isPauseRequested ? t->rampStep * 3 : t->rampStep;
+      if (t->jerkStep != 0) {
+        jerkRampTick(t, floorRPM,
+                     isPauseRequested ? t->accelMax * 3 : t->accelMax);
+      } else if (t->currentRPM > floorRPM) {
+        if (t->currentRPM > floorRPM + rpmStep)
+          t->currentRPM -= rpmStep;
+        else
+          t->currentRPM = floorRPM;
+      }
+    } else if (t->jerkStep != 0) {
+      jerkRampTick(t, RPM_Q(t->targetRPM), t->accelMax);
+    } else if (t->currentRPM < RPM_Q(t->targetRPM)) {
+      t->currentRPM += t->rampStep;
+      if (t->currentRPM > RPM_Q(t->targetRPM))
+        t->currentRPM = RPM_Q(t->targetRPM);
     }
-  } else if (t->currentRPM < t->targetRPM) {
-    t->currentRPM += rpmStep;
-    t->accelDistance++;
-    if (t->currentRPM > t->targetRPM)
-      t->currentRPM = t->targetRPM;
   }
   calculateCachedDelay(t);
 }
 
+// One S-curve tick towards goalRPM. The acceleration only changes by
+// jerkStep per tick; rampBrake is the speed it still adds while easing off to
+// 0, so easing starts exactly when that would close the gap to the goal.
+// Adds and compares only, the speed keeps ACCEL_SHIFT extra bits.
+void jerkRampTick(Task *t, uint32_t goalRPM, uint32_t accelMax) {
+  uint32_t rpm = (t->currentRPM << ACCEL_SHIFT) | t->rpmFraction;
+  uint32_t goal = goalRPM << ACCEL_SHIFT;
+  bool up = goal > rpm;
+  uint32_t gap = up ? goal - rpm : rpm - goal;
+  int32_t jerk = t->jerkStep;
+  int32_t accel = up ? t->rampAccel : -t->rampAccel; // towards the goal
+
+  if (accel < 0) {
+    t->rampBrake -= -accel - jerk; // still heading away, turn around
+    accel += jerk;
+  } else if (accel > (int32_t)accelMax || t->rampBrake + accel > gap) {
+    accel -= jerk; // ease off, lands on the goal
+    t->rampBrake -= accel;
+  } else if (accel < (int32_t)accelMax &&
+             t->rampBrake + 2 * accel + jerk <= gap) {
+    t->rampBrake += accel; // room for more acceleration
+    accel += jerk;
+  }
+
+  if ((int32_t)gap <= accel || (accel == 0 && (int32_t)gap < jerk)) {
+    rpm = goal;
+    accel = 0;
+    t->rampBrake = 0;
+  } else {
+    rpm = up ? rpm + accel : rpm - accel;
+  }
+  t->currentRPM = rpm >> ACCEL_SHIFT;
+  t->rpmFraction = rpm & ((1 << ACCEL_SHIFT) - 1);
+  t->rampAccel = up ? accel : -accel;
+}
+
 void handleHomingLogic(Task *t) {
   if (t->state != HOMING)
     return;
@@ -556,44 +777,55 @@ void handleHomingLogic(Task *t) {
   }
 
   // --- FAZA 0 lub 2: Szukamy fizycznego kliknięcia ---
+  // The ISR has already stopped stepping (stepperHalted) when the switch
+  // closed; the task may be modified safely until the halt is cleared.
   if (homingPhase == 0 || homingPhase == 2) {
-    if (digitalRead(LIMIT_PIN) == LOW) {
+    if (stepperHalted) {
       if (homingPhase == 0) {
         homingPhase = 1;
-        t->currentSteps = 0;
-        t->targetSteps = (long)(cfg.backoffDistanceMM * stepsPerMM);
-        t->dir = -t->dir;
-        digitalWrite(T_DIR, (t->dir == 1) ? cfg.dirT : !cfg.dirT);
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+          t->currentSteps = 0;
+          t->targetSteps = (long)(cfg.backoffDistanceMM * stepsPerMM);
+          t->dir = -t->dir;
+          stepperHalted = false;
+        }
+        planTaskRamp(t);
         Serial.println(F("MSG: Switch hit. Phase 1 (Backoff)"));
       } else {
-        absPos = 0;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+          absPos = 0;
+          t->currentSteps = t->targetSteps; // Koniec zadania
+        }
         isHomed = true;
         homingPhase = 3;
-        t->currentSteps = t->targetSteps; // Koniec zadania
         Serial.println(F("MSG: Precision Home reached. Zero set."));
       }
     }
   }
 
   // --- FAZA 1: Koniec odjazdu -> start powolnego podejścia ---
-  if (homingPhase == 1 && t->currentSteps >= t->targetSteps) {
+  if (homingPhase == 1 && stepperReadSteps(t) >= t->targetSteps) {
     homingPhase = 2;
-    t->currentSteps = 0;
-
-    // ZABEZPIECZENIE 2: Zamiast 999999, dajemy np. 2x backoffDistance.
-    // Jeśli w tym dystansie nie trafi w switch, znaczy że coś jest nie tak.
-    t->targetSteps = (long)(cfg.backoffDistanceMM * 2.0 * stepsPerMM);
 
-    t->targetRPM = 20.0;
-    t->currentRPM = 20.0;
+    t->targetRPM = 20;
+    t->currentRPM = RPM_Q(20);
     t->accelRate = 0;
-    t->dir = -t->dir;
-    digitalWrite(T_DIR, (t->dir == 1) ? cfg.dirT : !cfg.dirT);
+    t->rampStep = 0;
+    t->jerkStep = 0;
+    calculateCachedDelay(t);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      t->currentSteps = 0;
+      // ZABEZPIECZENIE 2: Zamiast 999999, dajemy np. 2x backoffDistance.
+      // Jeśli w tym dystansie nie trafi w switch, znaczy że coś jest nie tak.
+      t->targetSteps = (long)(cfg.backoffDistanceMM * 2.0 * stepsPerMM);
+      t->dir = -t->dir;
+    }
     Serial.println(F("MSG: Phase 2 (Slow Touch)"));
   }
 
   // ZABEZPIECZENIE 3: Timeout (jeśli Phase 0 lub 2 przejechały za dużo)
-  if (t->currentSteps >= t->targetSteps &&
+  if (stepperReadSteps(t) >= t->targetSteps &&
       (homingPhase == 0 || homingPhase == 2)) {
     Serial.println(F("ERROR: Homing timeout! Switch not found."));
     t->state = ERROR;
@@ -605,11 +837,13 @@ void handleHomingLogic(Task *t) {
 // --- CORE FUNCTIONS: STOP & CLOSING TASK ---
 
 void emergencyStop(bool userAsked) {
-  digitalWrite(EN, HIGH); // Offline motors
+  stepperStop();
+  EnablePin::high(); // Offline motors
   clearQueue();
   if (userAsked) {
     Serial.println(F("Manual stop, queue cleared."));
   } else {
+    telemetryEvent(TLM_EV_ALARM);
     Serial.println(
         F("ALARM: EMERGENCY STOP! Limit switch hit. Queue cleared."));
   }
@@ -619,18 +853,33 @@ void emergencyStop(bool userAsked) {
 void handleTaskEnd(Task *t) {
   bool isHomingFinished = (t->state == HOMING && homingPhase >= 3);
   bool isNormalTaskFinished =
-      (t->state != HOMING && t->currentSteps >= t->targetSteps);
+      (t->state != HOMING && stepperReadSteps(t) >= t->targetSteps);
 
   if (isHomingFinished || isNormalTaskFinished) {
+    // Either the engine already runs the chained task or it stops here
+    Task *next = stepperFinish(t);
     t->isComplete = true;
     dequeueTask();
 
+    if (next != NULL) {
+      // Continue from the speed we actually reached, not the planned one
+      if (next->currentRPM > t->currentRPM) {
+        next->currentRPM = max(RPM_Q(next->startRPM), t->currentRPM);
+        planTaskRamp(next);
+      }
+      next->lastRampUpdate = millis();
+      calculateCachedDelay(next);
+      nextProgressReport = (long)cfg.stepsPerRevW * 10;
+    }
+
     if (taskCount == 0)
-      digitalWrite(EN, HIGH);
+      EnablePin::high();
 
     if (t->state == HOMING) {
+      telemetryEvent(TLM_EV_HOMED);
       Serial.println(F("MSG: Homing finished. Zero established."));
     } else {
+      telemetryEvent(TLM_EV_TASK_DONE);
       Serial.println(F("MSG: Task complete."));
     }
     printStatus();
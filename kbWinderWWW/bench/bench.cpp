@@ -0,0 +1,795 @@
+/**
+ * kbWinderWWW host bench.
+ *
+ * Builds the ESP firmware against the stand-ins in hal/ and drives it with
+ * a virtual clock: setup() once, then loop() while the bench plays the Nano
+ * on the other end of the UART and a few WebSocket clients on the network.
+ *
+ * Benchmarks (host numbers are relative; heap numbers are what the
+ * firmware itself asks malloc for, library buffers excluded):
+ *  - Nano lines/sec through UART -> line splitter -> WebSocket outboxes,
+ *  - heap allocations per status broadcast,
+ *  - command batch latency with the ACK window at 57600 baud,
+ *    and that a late ACK does not free credits of newer commands.
+ *
+ * Fuzzing (seeded, reproducible):
+ *  - line splitter against a reference model, with telemetry frames mixed
+ *    in, and with hostile input (stray zero bytes, control characters),
+ *  - command batching against a Nano model that drops ACKs and checks its
+ *    64-byte RX buffer.
+ *
+ * Exit status is non-zero if a fuzz check fails.
+ */
+
+#include "sketch.cpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// --- Heap accounting ---
+
+struct HeapCount {
+  uint64_t allocs = 0;
+  uint64_t bytes = 0;
+};
+
+static HeapCount heapCount;
+static bool heapCounting = false;
+
+#ifndef BENCH_SANITIZE
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t n, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+static inline void countAlloc(size_t size) {
+  if (heapCounting) {
+    heapCount.allocs++;
+    heapCount.bytes += size;
+  }
+}
+
+extern "C" void *malloc(size_t size) noexcept {
+  countAlloc(size);
+  return __libc_malloc(size);
+}
+extern "C" void *calloc(size_t n, size_t size) noexcept {
+  countAlloc(n * size);
+  return __libc_calloc(n, size);
+}
+extern "C" void *realloc(void *ptr, size_t size) noexcept {
+  countAlloc(size);
+  return __libc_realloc(ptr, size);
+}
+extern "C" void free(void *ptr) noexcept { __libc_free(ptr); }
+
+void *benchUncountedAlloc(size_t size) { return __libc_malloc(size); }
+void benchUncountedFree(void *ptr) { __libc_free(ptr); }
+#else
+// Sanitizers bring their own allocator: no counting in SAN=1 builds
+void *benchUncountedAlloc(size_t size) { return malloc(size); }
+void benchUncountedFree(void *ptr) { free(ptr); }
+#endif
+
+static const bool heapCounted =
+#ifndef BENCH_SANITIZE
+    true;
+#else
+    false;
+#endif
+
+/** @brief Counts the firmware's heap use while in scope. */
+struct HeapScope {
+  HeapCount start;
+  HeapScope() : start(heapCount) { heapCounting = true; }
+  ~HeapScope() { heapCounting = false; }
+  HeapCount used() const { return {heapCount.allocs - start.allocs, heapCount.bytes - start.bytes}; }
+};
+
+// --- Core stand-in globals ---
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+EspClass ESP;
+ESP8266WiFiClass WiFi;
+FS LittleFS;
+MDNSResponder MDNS;
+ESP8266NetBIOS NBNS;
+SSDPClass SSDP;
+ArduinoOTAClass ArduinoOTA;
+netif *netif_list = nullptr;
+netif *netif_default = nullptr;
+
+static uint64_t nowUs = 0;
+
+unsigned long millis() { return (unsigned long)(nowUs / 1000); }
+unsigned long micros() { return (unsigned long)nowUs; }
+void delay(unsigned long ms) { nowUs += (uint64_t)ms * 1000; }
+void yield() {}
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return HIGH; } // przycisk FLASH nie wciśnięty
+
+uint32_t EspClass::getFreeHeap() { return 30000; }
+void EspClass::restart() {}
+
+// --- Helpers ---
+
+static const uint64_t UART_BYTE_US = 174; // 10 bitów przy 57600 bodów
+
+static double wallSeconds() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void tick(uint64_t us) {
+  nowUs += us;
+  loop();
+}
+
+static void pushRx(const std::string &bytes) { Serial.rx.insert(Serial.rx.end(), bytes.begin(), bytes.end()); }
+
+static void drainClients() {
+  for (auto *c : ws->getClients())
+    c->drain();
+}
+
+/** @brief A Nano status frame as the Nano firmware sends it (TELEMETRY ON). */
+static std::string telemetryFrame(uint8_t seq, int32_t steps, int32_t rpmQ, int32_t absPos, uint16_t layer) {
+  uint8_t raw[TLM_STATUS_SIZE + 2] = {TLM_STATUS, seq, 3, 'W', TLM_F_HOMED, 1};
+  writeLE(raw + 6, steps, 4);
+  writeLE(raw + 10, 200000, 4);
+  writeLE(raw + 14, rpmQ, 4);
+  writeLE(raw + 18, absPos, 4);
+  writeLE(raw + 22, layer, 2);
+  uint16_t crc = telemetryCrc16(raw, TLM_STATUS_SIZE);
+  raw[TLM_STATUS_SIZE] = crc & 0xFF;
+  raw[TLM_STATUS_SIZE + 1] = crc >> 8;
+
+  // COBS
+  std::string out(1, '\0');
+  size_t codeAt = out.size();
+  out += '\1';
+  for (uint8_t b : raw) {
+    if (b == 0) {
+      codeAt = out.size();
+      out += '\1';
+    } else {
+      out += (char)b;
+      out[codeAt]++;
+    }
+  }
+  out += '\0';
+  return out;
+}
+
+static const char *const CONSOLE_LINES[] = {
+    "MSG: Progress (12.0 turns / 200)",
+    "State: RUNNING",
+    "Current Task: WIND (2 queued)",
+    "Progress: 45.2",
+    "Current RPM: 120.5",
+    "Abs Position: 12.345",
+    "MSG: Layer Flip (40.0 turns / 200)",
+    "[MACHINE] SCREW PITCH: 1.000",
+    "MSG: Task complete",
+    "Some unparsed diagnostic output from the Nano",
+};
+
+struct Report {
+  int failures = 0;
+  void check(bool ok, const char *what) {
+    if (!ok) {
+      failures++;
+      printf("  FAIL: %s\n", what);
+    }
+  }
+};
+
+static Report report;
+
+// --- Benchmarks ---
+
+/**
+ * @brief Nano console lines through processSerialInput() to two clients.
+ * One line arrives per millisecond, loop() runs after each.
+ */
+static void benchLines(uint32_t lines) {
+  AsyncWebSocketClient *a = ws->connect();
+  AsyncWebSocketClient *b = ws->connect();
+  a->window = b->window = SIZE_MAX;
+  for (int i = 0; i < 10; i++)
+    tick(1000);
+
+  std::vector<std::string> input;
+  for (uint32_t i = 0; i < lines; i++)
+    input.push_back(std::string(CONSOLE_LINES[i % (sizeof(CONSOLE_LINES) / sizeof(*CONSOLE_LINES))]) + "\r\n");
+  uint64_t messagesBefore = a->messages;
+
+  double t0 = wallSeconds();
+  HeapScope heap;
+  for (auto const &line : input) {
+    pushRx(line);
+    tick(1000);
+    drainClients();
+  }
+  HeapCount used = heap.used();
+  double elapsed = wallSeconds() - t0;
+
+  printf("Nano lines -> WebSocket (2 clients, %u lines)\n", lines);
+  printf("  %-28s %12.0f lines/s (host)\n", "throughput", lines / elapsed);
+  printf("  %-28s %12.2f us/line (host)\n", "loop() cost", elapsed * 1e6 / lines);
+  if (heapCounted) {
+    printf("  %-28s %12.2f allocs/line\n", "heap", (double)used.allocs / lines);
+    printf("  %-28s %12.1f bytes/line\n", "", (double)used.bytes / lines);
+  }
+  printf("  %-28s %12llu\n", "messages to client #1", (unsigned long long)(a->messages - messagesBefore));
+  report.check(a->messages - messagesBefore >= lines, "every line reached the client");
+
+  ws->disconnect(a);
+  ws->disconnect(b);
+  tick(1000);
+}
+
+/**
+ * @brief Heap use of sendUnifiedStatus() broadcasts plus sending them.
+ */
+static void benchStatus(uint8_t clients, bool full) {
+  std::vector<AsyncWebSocketClient *> connected;
+  for (uint8_t i = 0; i < clients; i++)
+    connected.push_back(ws->connect());
+  tick(1000);
+  drainClients();
+
+  const uint32_t rounds = 1000;
+  double t0 = wallSeconds();
+  HeapScope heap;
+  for (uint32_t i = 0; i < rounds; i++) {
+    nowUs += 1000;
+    sendUnifiedStatus(nullptr, nullptr, true, full);
+    processWsOutboxes();
+    drainClients();
+  }
+  HeapCount used = heap.used();
+  double elapsed = wallSeconds() - t0;
+
+  printf("Status broadcast (%s, %u client%s, %u bytes)\n", full ? "full" : "minimal", clients, clients == 1 ? "" : "s",
+         (unsigned)statusCache.length[full ? 1 : 0]);
+  printf("  %-28s %12.2f us (host)\n", "build + send", elapsed * 1e6 / rounds);
+  if (heapCounted) {
+    printf("  %-28s %12.2f allocs/broadcast\n", "heap", (double)used.allocs / rounds);
+    printf("  %-28s %12.1f bytes/broadcast\n", "", (double)used.bytes / rounds);
+  }
+  report.check(!statusArena.overflowed(), "status fits its arena");
+
+  for (auto *c : connected)
+    ws->disconnect(c);
+  tick(1000);
+}
+
+/**
+ * @brief The Nano end of the UART: RX buffer, command parser and ACKs.
+ * Bytes travel at UART speed both ways. The Nano reads its RX buffer only
+ * while it is not running a command.
+ */
+struct NanoModel {
+  std::mt19937 *rng = nullptr;
+  double ackDropRate = 0;
+  uint32_t execMinUs = 200;
+  uint32_t execMaxUs = 200;
+
+  size_t txRead = 0;
+  uint64_t toNanoFreeAt = 0;
+  uint64_t toEspFreeAt = 0;
+  std::deque<std::pair<uint64_t, char>> toNano; ///< Bytes on the wire
+  std::deque<std::pair<uint64_t, char>> toEsp;
+  std::deque<char> rxBuffer;                    ///< Nano RX buffer (64 bytes)
+  std::string line;
+  uint64_t busyUntil = 0;
+  std::string pendingAck;
+
+  std::vector<std::string> received; ///< Commands in the order they arrived
+  uint32_t overruns = 0;
+  uint32_t acksDropped = 0;
+  size_t maxRxBuffer = 0;
+
+  void step() {
+    // ESP -> kabel
+    while (txRead < Serial.tx.size()) {
+      toNanoFreeAt = max(toNanoFreeAt, nowUs) + UART_BYTE_US;
+      toNano.emplace_back(toNanoFreeAt, Serial.tx[txRead++]);
+    }
+    if (txRead > 65536) {
+      Serial.tx.erase(0, txRead);
+      txRead = 0;
+    }
+    // kabel -> bufor RX Nano
+    while (!toNano.empty() && toNano.front().first <= nowUs) {
+      if (rxBuffer.size() >= 64)
+        overruns++;
+      else
+        rxBuffer.push_back(toNano.front().second);
+      toNano.pop_front();
+    }
+    maxRxBuffer = max(maxRxBuffer, rxBuffer.size());
+
+    if (nowUs >= busyUntil && !pendingAck.empty()) {
+      send(pendingAck);
+      pendingAck.clear();
+    }
+    while (nowUs >= busyUntil && !rxBuffer.empty()) {
+      char c = rxBuffer.front();
+      rxBuffer.pop_front();
+      if (c != '\n') {
+        line += c;
+        continue;
+      }
+      execute(line);
+      line.clear();
+    }
+
+    // kabel -> ESP
+    while (!toEsp.empty() && toEsp.front().first <= nowUs) {
+      Serial.rx.push_back(toEsp.front().second);
+      toEsp.pop_front();
+    }
+  }
+
+  void execute(const std::string &text) {
+    if (text.empty() || text[0] != '#')
+      return;
+    size_t space = text.find(' ');
+    received.push_back(space == std::string::npos ? std::string() : text.substr(space + 1));
+    uint32_t exec = execMinUs + (rng ? (*rng)() % (execMaxUs - execMinUs + 1) : 0);
+    busyUntil = nowUs + exec;
+    if (rng && std::uniform_real_distribution<>(0, 1)(*rng) < ackDropRate) {
+      acksDropped++;
+      return;
+    }
+    pendingAck = "ACK " + text.substr(1, space - 1) + "\n";
+  }
+
+  void send(const std::string &text) {
+    for (char c : text) {
+      toEspFreeAt = max(toEspFreeAt, nowUs) + UART_BYTE_US;
+      toEsp.emplace_back(toEspFreeAt, c);
+    }
+  }
+
+  bool idle() const { return toNano.empty() && toEsp.empty() && rxBuffer.empty() && pendingAck.empty() && nowUs >= busyUntil; }
+};
+
+static void sendBatch(const String &batch) {
+  AsyncWebServerRequest request("/api/cmd");
+  request.addParam("cmd", batch);
+  server->dispatch(&request);
+}
+
+static bool queueIdle() { return commandQueue.empty() && commandsInFlight.empty(); }
+
+/**
+ * @brief Largest status the firmware can build: every bounded field at its
+ * maximum, debug fields and the IP notification on. Both kinds must fit
+ * the arena and their buffers without truncation.
+ */
+static void checkStatusWorstCase() {
+  WinderState saved = winderState;
+  SystemConfiguration savedSystem = configuration.system;
+  String savedSsid = WiFi.staSsid, savedApSsid = WiFi.apSsid;
+
+  winderState.settings.clear();
+  for (int i = 0; i < WINDER_SETTINGS_MAX + 5; i++) {
+    char key[WINDER_SETTING_KEY_LEN + 1];
+    snprintf(key, sizeof(key), "%0*d", WINDER_SETTING_KEY_LEN, i);
+    pushRx("[MACHINE] " + std::string(key) + ": " + std::string(WINDER_SETTING_VALUE_LEN + 10, '9') + "\n");
+  }
+  pushRx("ERROR: " + std::string(NANO_LINE_BUFFER_SIZE, 'x') + "\n");
+  pushRx(telemetryFrame(1, -2000000000, 4000 * 256, -2000000000, 65535));
+  tick(1000);
+  configuration.system.webDebugEnabled = true;
+  configuration.system.mdnsEnabled = true;
+  memset(configuration.system.hostName, 'h', sizeof(configuration.system.hostName) - 1);
+  configuration.system.hostName[sizeof(configuration.system.hostName) - 1] = 0;
+  WiFi.staSsid = String(std::string(32, 's').c_str());
+  WiFi.apSsid = String(std::string(32, 'a').c_str());
+
+  printf("Status worst case\n");
+  bool fits = true;
+  for (uint8_t kind = 0; kind < 2; kind++) {
+    pendingIpNotify = true;
+    buildStatusJson(kind == 1);
+    // Pretty-printed only when that fits, so the compact size is what counts
+    size_t compact = measureJson(statusArena);
+    printf("  %-28s %12u bytes JSON, %u bytes arena (buffer %u, arena %u)\n", kind ? "full" : "minimal", (unsigned)compact,
+           (unsigned)statusArena.memoryUsage(), (unsigned)statusCache.size[kind], (unsigned)STATUS_ARENA_SIZE);
+    fits = fits && !statusArena.overflowed() && compact < statusCache.size[kind] &&
+           strstr(statusCache.json[kind], "\"truncated\"") == nullptr;
+  }
+  report.check(winderState.settings.size() == WINDER_SETTINGS_MAX, "settings cache stays bounded");
+  report.check(fits, "worst-case status fits its arena and buffers");
+
+  pendingIpNotify = false;
+  winderState = saved;
+  configuration.system = savedSystem;
+  WiFi.staSsid = savedSsid;
+  WiFi.apSsid = savedApSsid;
+  buildStatusJson(false);
+  buildStatusJson(true);
+}
+
+/**
+ * @brief Time from /api/cmd with a batch to the last ACK back on the ESP.
+ */
+static void benchBatch(uint8_t commands) {
+  NanoModel nano;
+  nano.txRead = Serial.tx.size();
+  String batch;
+  for (uint8_t i = 0; i < commands; i++)
+    batch += "SET SPEED " + String(100 + i) + "\n";
+
+  const uint32_t rounds = 20;
+  uint64_t totalUs = 0;
+  HeapCount heapTotal;
+  uint64_t txBefore = Serial.txBytes;
+  for (uint32_t r = 0; r < rounds; r++) {
+    uint64_t start = nowUs;
+    {
+      HeapScope heap;
+      sendBatch(batch);
+      HeapCount used = heap.used();
+      heapTotal.allocs += used.allocs;
+      heapTotal.bytes += used.bytes;
+    }
+    while (!queueIdle() || !nano.idle()) {
+      nowUs += 50;
+      nano.step();
+      loop();
+      drainClients();
+    }
+    totalUs += nowUs - start;
+    tick(20000);
+  }
+
+  uint64_t wireBytes = (Serial.txBytes - txBefore) / rounds;
+  double linkMs = wireBytes * UART_BYTE_US / 1000.0;
+  printf("Command batch (%u commands, %u bytes on the wire)\n", commands, (unsigned)wireBytes);
+  printf("  %-28s %12.2f ms (virtual, to last ACK)\n", "latency", totalUs / 1000.0 / rounds);
+  printf("  %-28s %12.2f ms (link alone)\n", "", linkMs);
+  printf("  %-28s %12u bytes (Nano RX buffer: 64)\n", "Nano RX peak", (unsigned)nano.maxRxBuffer);
+  if (heapCounted) {
+    printf("  %-28s %12.1f allocs/request\n", "heap", (double)heapTotal.allocs / rounds);
+    printf("  %-28s %12.1f bytes/request\n", "", (double)heapTotal.bytes / rounds);
+  }
+  report.check(nano.overruns == 0, "no Nano RX overrun");
+}
+
+/**
+ * @brief An ACK that arrives after the timeout dropped its command must not
+ * release the credits of commands sent since: their bytes may still be in
+ * the Nano's RX buffer.
+ */
+static void checkLateAck() {
+  sendBatch("STATUS\n");
+  tick(1000);
+  uint8_t lateSeq = commandsInFlight.front().seq;
+  tick((COMMAND_ACK_TIMEOUT_MS + 1) * 1000ULL); // the Nano stays silent
+  sendBatch("STATUS\nSTATUS\n");
+  tick(1000);
+  size_t inFlight = commandsInFlight.size();
+  uint16_t bytes = bytesInFlight;
+
+  pushRx("ACK " + std::to_string(lateSeq) + "\n");
+  tick(1000);
+  printf("Late ACK\n");
+  printf("  %-28s %12u of %u commands\n", "still in flight", (unsigned)commandsInFlight.size(), (unsigned)inFlight);
+  report.check(inFlight == 2 && commandsInFlight.size() == inFlight && bytesInFlight == bytes,
+               "late ACK keeps the credits of newer commands");
+
+  tick((COMMAND_ACK_TIMEOUT_MS + 1) * 1000ULL);
+}
+
+// --- Fuzzing ---
+
+/**
+ * @brief Collects the Nano lines a client got, in order.
+ */
+static std::vector<std::string> nanoLinesOf(AsyncWebSocketClient *client) {
+  std::vector<std::string> lines;
+  for (auto const &message : client->received) {
+    DynamicJsonDocument doc(1024);
+    if (deserializeJson(doc, message.c_str(), message.size()))
+      continue;
+    const char *type = doc["type"];
+    const char *level = doc["level"];
+    const char *text = doc["message"];
+    if (type && level && text && strcmp(type, "log") == 0 && strcmp(level, S_NANO) == 0)
+      lines.push_back(text);
+  }
+  client->received.clear();
+  return lines;
+}
+
+/**
+ * @brief Reference model of processSerialInput() + forwardNanoLine().
+ */
+struct LineModel {
+  std::string pending;
+  uint64_t lastTextMs = 0;
+  std::vector<std::string> lines;
+  uint32_t overflows = 0;
+
+  void emit() {
+    std::string s = pending;
+    pending.clear();
+    size_t a = 0, b = s.size();
+    while (b > a && isspace(s[b - 1]))
+      b--;
+    while (a < b && isspace(s[a]))
+      a++;
+    s = s.substr(a, b - a);
+    if (!s.empty() && s.compare(0, 4, "ACK ") != 0)
+      lines.push_back(s);
+  }
+  void text(char c) {
+    lastTextMs = millis();
+    if (c == '\n') {
+      emit();
+      return;
+    }
+    if (pending.size() == NANO_LINE_BUFFER_SIZE - 1) {
+      overflows++;
+      emit();
+    }
+    pending += c;
+  }
+  void afterLoop() {
+    if (!pending.empty() && millis() - lastTextMs > NANO_LINE_FLUSH_MS)
+      emit();
+  }
+};
+
+static std::string randomText(std::mt19937 &rng) {
+  static const char *const fragments[] = {"MSG: Progress (", "State: ", "ERROR ", "ALARM", "[MACHINE] PITCH: ", "ACK 7", "Task started",
+                                          "  ", "\t", "\r", "\n", "\r\n", "\n\n"};
+  std::string s;
+  uint32_t parts = 1 + rng() % 4;
+  for (uint32_t i = 0; i < parts; i++) {
+    switch (rng() % 4) {
+    case 0:
+      s += fragments[rng() % (sizeof(fragments) / sizeof(*fragments))];
+      break;
+    case 1: // długi ciąg bez końca linii
+      s += std::string(100 + rng() % 200, 'a' + rng() % 26);
+      break;
+    default:
+      for (uint32_t n = rng() % 20; n > 0; n--) {
+        uint8_t c = rng() % 256;
+        s += (char)(c == 0 ? ' ' : c);
+      }
+    }
+  }
+  return s;
+}
+
+/**
+ * @brief Line splitter vs the model: text and whole telemetry frames,
+ * random arrival chunks and random pauses (the 50 ms flush).
+ */
+static void fuzzLineSplitter(uint32_t iterations, uint32_t seed) {
+  std::mt19937 rng(seed);
+  AsyncWebSocketClient *client = ws->connect();
+  client->window = SIZE_MAX;
+  client->capture = true;
+  tick(100000); // wszystko, co wisiało, wychodzi
+  client->received.clear();
+
+  LineModel model;
+  uint32_t overflowsBefore = nanoLineOverflows;
+  uint32_t framesBefore = nanoTelemetry.frames;
+  uint32_t framesSent = 0;
+  uint8_t seq = nanoTelemetry.lastSeq;
+  size_t compared = 0;
+  bool ok = true;
+
+  for (uint32_t i = 0; i < iterations && ok; i++) {
+    // Wejście: tekst i ramki; przychodzi kawałkami po 1..30 bajtów
+    std::vector<std::pair<std::string, bool>> atoms; // (bajty, ramka?)
+    atoms.emplace_back(randomText(rng), false);
+    if (rng() % 3 == 0) {
+      atoms.emplace_back(telemetryFrame(++seq, rng(), rng() % 100000, rng(), rng()), true);
+      framesSent++;
+    }
+    for (auto const &atom : atoms) {
+      for (size_t at = 0; at < atom.first.size();) {
+        size_t n = min((size_t)(1 + rng() % 30), atom.first.size() - at);
+        std::string chunk = atom.first.substr(at, n);
+        at += n;
+        nowUs += 1000 + (rng() % 8 == 0 ? 60000 : 0);
+        pushRx(chunk);
+        if (!atom.second) {
+          for (char c : chunk)
+            model.text(c);
+        }
+        loop();
+        model.afterLoop();
+      }
+    }
+
+    std::vector<std::string> got = nanoLinesOf(client);
+    for (auto const &line : got) {
+      if (compared >= model.lines.size() || model.lines[compared] != line) {
+        printf("  line %u: got \"%s\", expected \"%s\"\n", (unsigned)compared, line.c_str(),
+               compared < model.lines.size() ? model.lines[compared].c_str() : "(nothing)");
+        ok = false;
+        break;
+      }
+      compared++;
+    }
+  }
+  tick(100000);
+  model.afterLoop();
+  std::vector<std::string> rest = nanoLinesOf(client);
+  compared += rest.size();
+
+  printf("Fuzz: line splitter (%u rounds, seed %u)\n", iterations, seed);
+  printf("  %-28s %12u\n", "lines forwarded", (unsigned)compared);
+  printf("  %-28s %12u\n", "overflow splits", nanoLineOverflows - overflowsBefore);
+  printf("  %-28s %12u / %u\n", "telemetry frames decoded", nanoTelemetry.frames - framesBefore, framesSent);
+  report.check(ok && compared == model.lines.size(), "forwarded lines match the reference model");
+  report.check(nanoLineOverflows - overflowsBefore == model.overflows, "overflow count matches");
+  report.check(nanoTelemetry.frames - framesBefore == framesSent, "every telemetry frame decoded");
+
+  ws->disconnect(client);
+  tick(1000);
+}
+
+/**
+ * @brief Any bytes at all, stray zeros included: no crash, and what comes
+ * out is still a well-formed line.
+ */
+static void fuzzHostileInput(uint32_t iterations, uint32_t seed) {
+  std::mt19937 rng(seed);
+  AsyncWebSocketClient *client = ws->connect();
+  client->window = SIZE_MAX;
+  client->capture = true;
+  tick(100000);
+  client->received.clear();
+
+  size_t lines = 0;
+  bool ok = true;
+  for (uint32_t i = 0; i < iterations; i++) {
+    std::string chunk;
+    for (uint32_t n = 1 + rng() % 30; n > 0; n--)
+      chunk += (char)(rng() % 4 == 0 ? rng() % 4 : rng() % 256); // dużo zer i sterujących
+    if (rng() % 10 == 0)
+      chunk += telemetryFrame(rng(), rng(), rng(), rng(), rng()).substr(rng() % 8);
+    nowUs += 1000 + (rng() % 8 == 0 ? 60000 : 0);
+    pushRx(chunk);
+    loop();
+    for (auto const &line : nanoLinesOf(client)) {
+      lines++;
+      if (line.empty() || line.size() > NANO_LINE_BUFFER_SIZE - 1 || isspace(line.front()) || isspace(line.back()))
+        ok = false;
+    }
+  }
+
+  printf("Fuzz: hostile UART input (%u rounds, seed %u)\n", iterations, seed);
+  printf("  %-28s %12u\n", "lines forwarded", (unsigned)lines);
+  printf("  %-28s %12u\n", "bad telemetry frames", nanoTelemetry.badFrames);
+  report.check(ok, "forwarded lines are trimmed, non-empty and at most 127 bytes");
+
+  ws->disconnect(client);
+  tick(1000);
+}
+
+/**
+ * @brief Random batches against the Nano model, with lost ACKs.
+ * Checks the window on every step, then exactly-once, in-order delivery
+ * and that the queue and its credits drain to zero.
+ */
+static void fuzzCommandBatching(uint32_t iterations, uint32_t seed) {
+  std::mt19937 rng(seed);
+  NanoModel nano;
+  nano.rng = &rng;
+  nano.ackDropRate = 0.02;
+  nano.execMinUs = 100;
+  nano.execMaxUs = 10000;
+  nano.txRead = Serial.tx.size();
+
+  std::vector<std::string> expected;
+  bool windowOk = true;
+  uint32_t batches = 0;
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    if (rng() % 2000 == 0) { // średnio co 100 ms
+      String batch;
+      for (uint32_t n = 1 + rng() % 12; n > 0; n--) {
+        std::string cmd;
+        uint32_t length = rng() % 8 == 0 ? 60 + rng() % 40 : rng() % 24; // czasem dłuższa niż okno
+        for (uint32_t k = 0; k < length; k++)
+          cmd += (char)(rng() % 10 == 0 ? ' ' : 'A' + rng() % 26);
+        batch += cmd.c_str();
+        batch += "\n";
+        String trimmed(cmd.c_str());
+        trimmed.trim();
+        if (trimmed.length() > 0)
+          expected.push_back(trimmed.c_str());
+      }
+      sendBatch(batch);
+      batches++;
+    }
+    nowUs += 50;
+    nano.step();
+    loop();
+    drainClients();
+    if (bytesInFlight > NANO_RX_WINDOW && commandsInFlight.size() > 1)
+      windowOk = false;
+  }
+  // Dajemy czas na wszystko, łącznie z timeoutem zgubionego ACK
+  uint64_t limit = nowUs + 600 * 1000000ULL;
+  for (uint64_t end = nowUs + 2 * COMMAND_ACK_TIMEOUT_MS * 1000; nowUs < limit && (nowUs < end || !nano.idle() || !queueIdle());) {
+    nowUs += 50;
+    nano.step();
+    loop();
+    drainClients();
+  }
+
+  printf("Fuzz: command batching (%u steps, seed %u)\n", iterations, seed);
+  printf("  %-28s %12u batches, %u commands\n", "sent", batches, (unsigned)expected.size());
+  printf("  %-28s %12u\n", "ACKs dropped", nano.acksDropped);
+  printf("  %-28s %12u bytes\n", "Nano RX peak", (unsigned)nano.maxRxBuffer);
+  report.check(windowOk, "bytes in flight stay within the Nano RX window");
+  report.check(nano.received == expected, "every command delivered once, in order");
+  report.check(nano.overruns == 0, "no Nano RX overrun");
+  report.check(commandQueue.empty() && commandsInFlight.empty() && bytesInFlight == 0, "queue and credits drain to zero");
+}
+
+// --- Main ---
+
+int main(int argc, char **argv) {
+  uint32_t lines = 20000;
+  uint32_t fuzzRounds = 20000;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc)
+      lines = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--fuzz") == 0 && i + 1 < argc)
+      fuzzRounds = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+      seed = strtoul(argv[++i], nullptr, 10);
+    else {
+      printf("usage: %s [--lines N] [--fuzz N] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  Serial.tx.reserve(1 << 20);
+  setup();
+  for (int i = 0; i < 100; i++)
+    tick(1000);
+
+  // Realistyczny stan do statusu: konsola Nano i telemetria
+  for (auto const *line : CONSOLE_LINES)
+    pushRx(std::string(line) + "\n");
+  pushRx(telemetryFrame(1, 1000, 120 * 256, 5000, 3));
+  tick(1000);
+
+  printf("kbWinderWWW bench%s\n\n", heapCounted ? "" : " (sanitizers on, heap not counted)");
+  benchLines(lines);
+  benchStatus(1, false);
+  benchStatus(4, false);
+  benchStatus(4, true);
+  checkStatusWorstCase();
+  benchBatch(1);
+  benchBatch(10);
+  checkLateAck();
+
+  printf("\n");
+  fuzzLineSplitter(fuzzRounds, seed);
+  fuzzHostileInput(fuzzRounds, seed);
+  fuzzCommandBatching(fuzzRounds * 100, seed);
+
+  printf("\n%s\n", report.failures ? "FAILED" : "OK");
+  return report.failures ? 1 : 0;
+}
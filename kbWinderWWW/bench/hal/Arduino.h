@@ -0,0 +1,436 @@
+/**
+ * Host-side stand-in for the ESP8266 Arduino core, just enough to build
+ * kbWinderWWW on Linux. Time is virtual and advanced by the bench; String
+ * and everything else allocate through malloc, so the bench can count
+ * heap traffic the way it would add up on the ESP.
+ */
+
+#ifndef BENCH_ARDUINO_H
+#define BENCH_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint8_t uint8;
+typedef int8_t sint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define LED_BUILTIN 2
+
+#define DEC 10
+#define HEX 16
+
+// --- Flash strings: flash and RAM share one address space here ---
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+class __FlashStringHelper;
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper *>(p))
+#define F(s) FPSTR(PSTR(s))
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define strstr_P strstr
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+template <typename A, typename B> typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template <typename A, typename B> typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template <typename A, typename L, typename H> A constrain(A x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t n = strlen(src);
+  if (size > 0) {
+    size_t m = n < size - 1 ? n : size - 1;
+    memcpy(dst, src, m);
+    dst[m] = 0;
+  }
+  return n;
+}
+#endif
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+// --- String (small strings inline, like the ESP core's SSO) ---
+
+class String {
+public:
+  String(const char *s = "") { assign(s, s ? strlen(s) : 0); }
+  String(const char *s, size_t n) { assign(s, n); }
+  String(const String &s) { assign(s.c_str(), s.len); }
+  String(String &&s) noexcept { move(s); }
+  String(const __FlashStringHelper *s) : String(reinterpret_cast<const char *>(s)) {}
+  explicit String(char c) { assign(&c, 1); }
+  explicit String(unsigned char v, unsigned char base = 10) : String((unsigned long)v, base) {}
+  explicit String(int v, unsigned char base = 10) : String((long)v, base) {}
+  explicit String(unsigned int v, unsigned char base = 10) : String((unsigned long)v, base) {}
+  explicit String(long v, unsigned char base = 10) {
+    char b[24];
+    snprintf(b, sizeof(b), base == 16 ? "%lx" : "%ld", v);
+    assign(b, strlen(b));
+  }
+  explicit String(unsigned long v, unsigned char base = 10) {
+    char b[24];
+    snprintf(b, sizeof(b), base == 16 ? "%lx" : "%lu", v);
+    assign(b, strlen(b));
+  }
+  explicit String(float v, unsigned char decimals = 2) : String((double)v, decimals) {}
+  explicit String(double v, unsigned char decimals = 2) {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", decimals, v);
+    assign(b, strlen(b));
+  }
+  ~String() {
+    if (heap)
+      free(heap);
+  }
+
+  String &operator=(const String &s) {
+    if (this != &s)
+      assign(s.c_str(), s.len);
+    return *this;
+  }
+  String &operator=(String &&s) noexcept {
+    if (this != &s) {
+      if (heap)
+        free(heap);
+      move(s);
+    }
+    return *this;
+  }
+  String &operator=(const char *s) { return assign(s, s ? strlen(s) : 0); }
+  String &operator=(const __FlashStringHelper *s) { return *this = reinterpret_cast<const char *>(s); }
+
+  const char *c_str() const { return heap ? heap : sso; }
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+  explicit operator bool() const { return true; }
+  char operator[](unsigned int i) const { return i < len ? c_str()[i] : 0; }
+  char &operator[](unsigned int i) { return buffer()[i]; }
+  char charAt(unsigned int i) const { return (*this)[i]; }
+
+  bool reserve(unsigned int size) {
+    if (size < capacity())
+      return true;
+    char *p = (char *)realloc(heap, size + 1);
+    if (p == nullptr)
+      return false;
+    if (heap == nullptr)
+      memcpy(p, sso, len + 1);
+    heap = p;
+    cap = size + 1;
+    return true;
+  }
+
+  bool concat(const char *s, size_t n) {
+    if (!reserve(len + n))
+      return false;
+    memmove(buffer() + len, s, n);
+    len += n;
+    buffer()[len] = 0;
+    return true;
+  }
+  String &operator+=(const String &s) { return concat(s.c_str(), s.len), *this; }
+  String &operator+=(const char *s) { return concat(s, strlen(s)), *this; }
+  String &operator+=(const __FlashStringHelper *s) { return *this += reinterpret_cast<const char *>(s); }
+  String &operator+=(char c) { return concat(&c, 1), *this; }
+  String &operator+=(int v) { return *this += String(v); }
+  String &operator+=(unsigned int v) { return *this += String(v); }
+  String &operator+=(long v) { return *this += String(v); }
+  String &operator+=(unsigned long v) { return *this += String(v); }
+
+  int compareTo(const String &s) const { return strcmp(c_str(), s.c_str()); }
+  bool equals(const char *s) const { return strcmp(c_str(), s) == 0; }
+  bool operator==(const String &s) const { return len == s.len && equals(s.c_str()); }
+  bool operator==(const char *s) const { return equals(s); }
+  bool operator==(const __FlashStringHelper *s) const { return equals(reinterpret_cast<const char *>(s)); }
+  bool operator!=(const String &s) const { return !(*this == s); }
+  bool operator!=(const char *s) const { return !equals(s); }
+  bool operator<(const String &s) const { return compareTo(s) < 0; }
+
+  bool startsWith(const String &s) const { return s.len <= len && strncmp(c_str(), s.c_str(), s.len) == 0; }
+  bool endsWith(const String &s) const { return s.len <= len && strcmp(c_str() + len - s.len, s.c_str()) == 0; }
+
+  int indexOf(char c, unsigned int from = 0) const {
+    if (from >= len)
+      return -1;
+    const char *p = strchr(c_str() + from, c);
+    return p ? p - c_str() : -1;
+  }
+  int indexOf(const String &s, unsigned int from = 0) const {
+    if (from > len)
+      return -1;
+    const char *p = strstr(c_str() + from, s.c_str());
+    return p ? p - c_str() : -1;
+  }
+  int lastIndexOf(char c) const {
+    const char *p = strrchr(c_str(), c);
+    return p ? p - c_str() : -1;
+  }
+
+  String substring(unsigned int from) const { return substring(from, len); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to)
+      std::swap(from, to);
+    if (from > len)
+      return String();
+    to = to > len ? len : to;
+    return String(c_str() + from, to - from);
+  }
+
+  void trim() {
+    const char *s = c_str();
+    size_t begin = 0, end = len;
+    while (begin < end && isspace((unsigned char)s[begin]))
+      begin++;
+    while (end > begin && isspace((unsigned char)s[end - 1]))
+      end--;
+    memmove(buffer(), s + begin, end - begin);
+    len = end - begin;
+    buffer()[len] = 0;
+  }
+  void remove(unsigned int index) { remove(index, len > index ? len - index : 0); }
+  void remove(unsigned int index, unsigned int count) {
+    if (index >= len)
+      return;
+    count = count > len - index ? len - index : count;
+    memmove(buffer() + index, c_str() + index + count, len - index - count + 1);
+    len -= count;
+  }
+  void replace(const String &from, const String &to) {
+    if (from.len == 0)
+      return;
+    String out;
+    const char *s = c_str();
+    const char *p;
+    while ((p = strstr(s, from.c_str())) != nullptr) {
+      out.concat(s, p - s);
+      out += to;
+      s = p + from.len;
+    }
+    out += s;
+    *this = std::move(out);
+  }
+  void toLowerCase() {
+    for (size_t i = 0; i < len; i++)
+      buffer()[i] = tolower((unsigned char)buffer()[i]);
+  }
+  void toUpperCase() {
+    for (size_t i = 0; i < len; i++)
+      buffer()[i] = toupper((unsigned char)buffer()[i]);
+  }
+  long toInt() const { return atol(c_str()); }
+  float toFloat() const { return atof(c_str()); }
+
+private:
+  static const size_t SSO_SIZE = 11; // as on the ESP8266 core (10 chars + NUL)
+  char sso[SSO_SIZE] = {0};
+  char *heap = nullptr;
+  size_t len = 0;
+  size_t cap = 0;
+
+  size_t capacity() const { return heap ? cap - 1 : SSO_SIZE - 1; }
+  char *buffer() { return heap ? heap : sso; }
+  String &assign(const char *s, size_t n) {
+    if (n > capacity() && !reserve(n))
+      return *this;
+    memmove(buffer(), s, n);
+    len = n;
+    buffer()[len] = 0;
+    return *this;
+  }
+  void move(String &s) {
+    memcpy(sso, s.sso, SSO_SIZE);
+    heap = s.heap;
+    len = s.len;
+    cap = s.cap;
+    s.heap = nullptr;
+    s.len = 0;
+    s.sso[0] = 0;
+  }
+};
+
+inline String operator+(const String &a, const String &b) {
+  String r(a);
+  r += b;
+  return r;
+}
+inline String operator+(const String &a, const char *b) {
+  String r(a);
+  r += b;
+  return r;
+}
+inline String operator+(const char *a, const String &b) {
+  String r(a);
+  r += b;
+  return r;
+}
+inline String operator+(const String &a, char b) {
+  String r(a);
+  r += b;
+  return r;
+}
+inline String operator+(const __FlashStringHelper *a, const String &b) { return reinterpret_cast<const char *>(a) + b; }
+inline String operator+(const String &a, const __FlashStringHelper *b) { return a + reinterpret_cast<const char *>(b); }
+inline String operator+(String &&a, const String &b) {
+  a += b;
+  return std::move(a);
+}
+inline String operator+(String &&a, const char *b) {
+  a += b;
+  return std::move(a);
+}
+
+// --- Print / Stream ---
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t write(const char *s, size_t n) { return write((const uint8_t *)s, n); }
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n; i++)
+      write(buf[i]);
+    return n;
+  }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const String &s) { return write(s.c_str(), s.length()); }
+  size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned int v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+    char b[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(b, sizeof(b), format, args);
+    va_end(args);
+    if (n < 0)
+      return 0;
+    return write((const uint8_t *)b, (size_t)n < sizeof(b) ? n : sizeof(b) - 1);
+  }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(uint8_t *buf, size_t n) {
+    size_t i = 0;
+    for (int c; i < n && (c = read()) >= 0; i++)
+      buf[i] = (uint8_t)c;
+    return i;
+  }
+  String readStringUntil(char terminator) {
+    String s;
+    for (int c; (c = read()) >= 0 && c != terminator;)
+      s += (char)c;
+    return s;
+  }
+};
+
+/**
+ * @brief UART stand-in. The bench fills "rx" with what the Nano sends and
+ * reads what the ESP wrote from "tx".
+ */
+class HardwareSerial : public Stream {
+public:
+  std::deque<uint8_t> rx;
+  std::string tx;
+  uint64_t txBytes = 0;
+
+  void begin(unsigned long) {}
+  void setRxBufferSize(size_t) {}
+  void swap() {}
+  int available() override { return rx.size(); }
+  int read() override {
+    if (rx.empty())
+      return -1;
+    uint8_t c = rx.front();
+    rx.pop_front();
+    return c;
+  }
+  int peek() override { return rx.empty() ? -1 : rx.front(); }
+  size_t write(uint8_t c) override {
+    tx += (char)c;
+    txBytes++;
+    return 1;
+  }
+  using Print::write;
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+// --- ESP ---
+
+#define USS(u) 0
+#define U0S 0
+
+enum FlashMode_t { FM_QIO, FM_QOUT, FM_DIO, FM_DOUT, FM_UNKNOWN };
+
+class EspClass {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getMaxFreeBlockSize() { return getFreeHeap(); }
+  uint8_t getHeapFragmentation() { return 0; }
+  uint8_t getCpuFreqMHz() { return 160; }
+  uint32_t getFlashChipSpeed() { return 40000000; }
+  FlashMode_t getFlashChipMode() { return FM_DIO; }
+  uint32_t getSketchSize() { return 400000; }
+  uint32_t getFreeSketchSpace() { return 600000; }
+  String getResetReason() { return "Bench"; }
+  void restart();
+};
+
+extern EspClass ESP;
+
+#include <IPAddress.h>
+
+#endif // BENCH_ARDUINO_H
@@ -0,0 +1,1194 @@
+/**
+ * Host stand-in for ArduinoJson 6: the subset of the API kbWinderWWW uses.
+ *
+ * Documents have ArduinoJson's memory semantics as seen on the ESP8266:
+ * a DynamicJsonDocument mallocs its capacity once, a StaticJsonDocument
+ * does not touch the heap, every value costs a 16-byte slot of the
+ * capacity, copied strings (char*, String, F()) cost their length + 1 and
+ * linked strings (const char*, zero-copy input) cost nothing. A document
+ * that runs out of capacity drops the value and reports overflowed().
+ * The host-side nodes live in an arena the bench does not count.
+ */
+
+#ifndef BENCH_ARDUINOJSON_H
+#define BENCH_ARDUINOJSON_H
+
+#include <Arduino.h>
+
+#include <errno.h>
+
+#include <limits>
+#include <type_traits>
+
+void *benchUncountedAlloc(size_t size);
+void benchUncountedFree(void *ptr);
+
+namespace ArduinoJsonShim {
+
+enum Type : uint8_t { J_NULL, J_BOOL, J_INT, J_UINT, J_FLOAT, J_STRING, J_OBJECT, J_ARRAY };
+
+struct Slot {
+  Slot *next;
+  const char *key;
+  Type type;
+  union {
+    bool b;
+    int64_t i;
+    uint64_t u;
+    double f;
+    const char *s;
+    struct {
+      Slot *head;
+      Slot *tail;
+    } c;
+  } v;
+};
+
+static const size_t ESP_SLOT_SIZE = 16;
+
+class Pool {
+public:
+  void init(size_t capacity) {
+    cap = capacity;
+    hostSize = capacity * 5 / 2 + 64; // Slot jest tu 40 B zamiast 16 B
+    host = (uint8_t *)benchUncountedAlloc(hostSize);
+    clear();
+  }
+  void release() {
+    benchUncountedFree(host);
+    host = nullptr;
+  }
+  void clear() {
+    hostUsed = espUsed = 0;
+    overflow = false;
+  }
+
+  Slot *newSlot() {
+    if (espUsed + ESP_SLOT_SIZE > cap)
+      return fail<Slot>();
+    Slot *s = (Slot *)hostAlloc(sizeof(Slot));
+    if (s == nullptr)
+      return fail<Slot>();
+    espUsed += ESP_SLOT_SIZE;
+    memset(s, 0, sizeof(Slot));
+    return s;
+  }
+  /** @brief Copies a string into the pool; charged against the capacity. */
+  const char *copyString(const char *s, size_t n) {
+    if (espUsed + n + 1 > cap)
+      return fail<const char>();
+    char *p = (char *)hostAlloc(n + 1);
+    if (p == nullptr)
+      return fail<const char>();
+    memcpy(p, s, n);
+    p[n] = 0;
+    espUsed += n + 1;
+    return p;
+  }
+  /** @brief Keeps a string that ArduinoJson would leave in the input buffer. */
+  const char *keepString(const char *s, size_t n) {
+    char *p = (char *)hostAlloc(n + 1);
+    if (p == nullptr)
+      return fail<const char>();
+    memcpy(p, s, n);
+    p[n] = 0;
+    return p;
+  }
+
+  size_t cap = 0;
+  size_t espUsed = 0;
+  bool overflow = false;
+
+private:
+  uint8_t *host = nullptr;
+  size_t hostSize = 0;
+  size_t hostUsed = 0;
+
+  template <typename T> T *fail() {
+    overflow = true;
+    return nullptr;
+  }
+  void *hostAlloc(size_t n) {
+    n = (n + 7) & ~(size_t)7;
+    if (host == nullptr || hostUsed + n > hostSize)
+      return nullptr;
+    void *p = host + hostUsed;
+    hostUsed += n;
+    return p;
+  }
+};
+
+// --- Keys and values ---
+
+struct Key {
+  const char *str;
+  bool copy;
+};
+inline Key makeKey(const char *k) { return {k, false}; }
+inline Key makeKey(char *k) { return {k, true}; }
+inline Key makeKey(const String &k) { return {k.c_str(), true}; }
+inline Key makeKey(const __FlashStringHelper *k) { return {reinterpret_cast<const char *>(k), true}; }
+
+inline Slot *findMember(const Slot *obj, const char *key) {
+  if (obj == nullptr || obj->type != J_OBJECT || key == nullptr)
+    return nullptr;
+  for (Slot *s = obj->v.c.head; s; s = s->next) {
+    if (strcmp(s->key, key) == 0)
+      return s;
+  }
+  return nullptr;
+}
+
+inline Slot *elementAt(const Slot *arr, size_t index) {
+  if (arr == nullptr || (arr->type != J_ARRAY && arr->type != J_OBJECT))
+    return nullptr;
+  Slot *s = arr->v.c.head;
+  while (s && index--)
+    s = s->next;
+  return s;
+}
+
+inline size_t childCount(const Slot *c) {
+  if (c == nullptr || (c->type != J_ARRAY && c->type != J_OBJECT))
+    return 0;
+  size_t n = 0;
+  for (Slot *s = c->v.c.head; s; s = s->next)
+    n++;
+  return n;
+}
+
+inline Slot *addChild(Pool *pool, Slot *container) {
+  if (container == nullptr)
+    return nullptr;
+  Slot *s = pool->newSlot();
+  if (s == nullptr)
+    return nullptr;
+  if (container->v.c.tail)
+    container->v.c.tail->next = s;
+  else
+    container->v.c.head = s;
+  container->v.c.tail = s;
+  return s;
+}
+
+inline Slot *getOrAddMember(Pool *pool, Slot *obj, Key key) {
+  if (obj == nullptr)
+    return nullptr;
+  if (obj->type == J_NULL) {
+    obj->type = J_OBJECT;
+    obj->v.c.head = obj->v.c.tail = nullptr;
+  }
+  if (obj->type != J_OBJECT)
+    return nullptr;
+  Slot *s = findMember(obj, key.str);
+  if (s)
+    return s;
+  const char *k = key.copy ? pool->copyString(key.str, strlen(key.str)) : key.str;
+  if (k == nullptr)
+    return nullptr;
+  s = addChild(pool, obj);
+  if (s)
+    s->key = k;
+  return s;
+}
+
+inline Slot *addElement(Pool *pool, Slot *arr) {
+  if (arr == nullptr)
+    return nullptr;
+  if (arr->type == J_NULL) {
+    arr->type = J_ARRAY;
+    arr->v.c.head = arr->v.c.tail = nullptr;
+  }
+  return arr->type == J_ARRAY ? addChild(pool, arr) : nullptr;
+}
+
+inline void makeContainer(Slot *s, Type type) {
+  s->type = type;
+  s->v.c.head = s->v.c.tail = nullptr;
+}
+
+inline bool setValue(Pool *, Slot *s, bool b) {
+  s->type = J_BOOL;
+  s->v.b = b;
+  return true;
+}
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, bool>::type setValue(Pool *, Slot *s, T v) {
+  if (std::is_signed<T>::value) {
+    s->type = J_INT;
+    s->v.i = (int64_t)v;
+  } else {
+    s->type = J_UINT;
+    s->v.u = (uint64_t)v;
+  }
+  return true;
+}
+template <typename T> typename std::enable_if<std::is_floating_point<T>::value, bool>::type setValue(Pool *, Slot *s, T v) {
+  s->type = J_FLOAT;
+  s->v.f = v;
+  return true;
+}
+inline bool setValue(Pool *, Slot *s, const char *str) {
+  s->type = str ? J_STRING : J_NULL;
+  s->v.s = str; // linked, no copy
+  return true;
+}
+inline bool setCopy(Pool *pool, Slot *s, const char *str, size_t n) {
+  const char *p = pool->copyString(str, n);
+  if (p == nullptr) {
+    s->type = J_NULL;
+    return false;
+  }
+  s->type = J_STRING;
+  s->v.s = p;
+  return true;
+}
+inline bool setValue(Pool *pool, Slot *s, char *str) { return str ? setCopy(pool, s, str, strlen(str)) : setValue(pool, s, (const char *)nullptr); }
+inline bool setValue(Pool *pool, Slot *s, const String &str) { return setCopy(pool, s, str.c_str(), str.length()); }
+inline bool setValue(Pool *pool, Slot *s, const __FlashStringHelper *str) {
+  return str ? setCopy(pool, s, reinterpret_cast<const char *>(str), strlen(reinterpret_cast<const char *>(str)))
+             : setValue(pool, s, (const char *)nullptr);
+}
+
+inline bool isNumber(const Slot *s) { return s && (s->type == J_INT || s->type == J_UINT || s->type == J_FLOAT); }
+
+inline double toDouble(const Slot *s) {
+  if (s == nullptr)
+    return 0;
+  switch (s->type) {
+  case J_BOOL:
+    return s->v.b;
+  case J_INT:
+    return (double)s->v.i;
+  case J_UINT:
+    return (double)s->v.u;
+  case J_FLOAT:
+    return s->v.f;
+  case J_STRING:
+    return strtod(s->v.s, nullptr);
+  default:
+    return 0;
+  }
+}
+
+template <typename T> struct Converter;
+
+} // namespace ArduinoJsonShim
+
+class JsonVariantConst;
+class JsonObjectConst;
+class JsonArrayConst;
+class JsonObject;
+class JsonArray;
+
+/**
+ * @brief Read access shared by every value reference: conversions, is<T>()
+ * and the "|" default. Derived classes provide slot().
+ */
+template <typename Derived> class JsonReadable {
+public:
+  template <typename T> T as() const { return ArduinoJsonShim::Converter<T>::as(self().slot()); }
+  template <typename T> bool is() const { return ArduinoJsonShim::Converter<T>::is(self().slot()); }
+  template <typename T> operator T() const { return as<T>(); }
+  template <typename T> T operator|(const T &fallback) const { return is<T>() ? as<T>() : fallback; }
+  const char *operator|(const char *fallback) const { return is<const char *>() ? as<const char *>() : fallback; }
+  bool isNull() const { return self().slot() == nullptr || self().slot()->type == ArduinoJsonShim::J_NULL; }
+  size_t size() const { return ArduinoJsonShim::childCount(self().slot()); }
+  template <typename K> bool containsKey(const K &key) const {
+    return ArduinoJsonShim::findMember(self().slot(), ArduinoJsonShim::makeKey(key).str) != nullptr;
+  }
+
+private:
+  const Derived &self() const { return static_cast<const Derived &>(*this); }
+};
+
+class JsonVariantConst : public JsonReadable<JsonVariantConst> {
+public:
+  JsonVariantConst(const ArduinoJsonShim::Slot *s = nullptr) : s(s) {}
+  const ArduinoJsonShim::Slot *slot() const { return s; }
+  template <typename K> JsonVariantConst operator[](const K &key) const {
+    return JsonVariantConst(ArduinoJsonShim::findMember(s, ArduinoJsonShim::makeKey(key).str));
+  }
+  JsonVariantConst operator[](int index) const { return JsonVariantConst(ArduinoJsonShim::elementAt(s, index)); }
+
+private:
+  const ArduinoJsonShim::Slot *s;
+};
+
+class JsonVariant : public JsonReadable<JsonVariant> {
+public:
+  JsonVariant(ArduinoJsonShim::Pool *pool = nullptr, ArduinoJsonShim::Slot *s = nullptr) : pool(pool), s(s) {}
+  const ArduinoJsonShim::Slot *slot() const { return s; }
+  template <typename T> bool set(const T &value) { return s && ArduinoJsonShim::setValue(pool, s, value); }
+  bool set(char *value) { return s && ArduinoJsonShim::setValue(pool, s, value); }
+  bool set(const char *value) { return s && ArduinoJsonShim::setValue(pool, s, value); }
+  template <typename T> JsonVariant &operator=(const T &value) {
+    set(value);
+    return *this;
+  }
+  template <typename T> T to();
+  operator JsonVariantConst() const { return JsonVariantConst(s); }
+
+private:
+  ArduinoJsonShim::Pool *pool;
+  ArduinoJsonShim::Slot *s;
+};
+
+class JsonObjectConst : public JsonReadable<JsonObjectConst> {
+public:
+  JsonObjectConst(const ArduinoJsonShim::Slot *s = nullptr) : s(s && s->type == ArduinoJsonShim::J_OBJECT ? s : nullptr) {}
+  const ArduinoJsonShim::Slot *slot() const { return s; }
+  template <typename K> JsonVariantConst operator[](const K &key) const {
+    return JsonVariantConst(ArduinoJsonShim::findMember(s, ArduinoJsonShim::makeKey(key).str));
+  }
+  explicit operator bool() const { return s != nullptr; }
+
+private:
+  const ArduinoJsonShim::Slot *s;
+};
+
+class JsonArrayConst : public JsonReadable<JsonArrayConst> {
+public:
+  class iterator {
+  public:
+    iterator(const ArduinoJsonShim::Slot *s) : s(s) {}
+    JsonVariantConst operator*() const { return JsonVariantConst(s); }
+    iterator &operator++() {
+      s = s->next;
+      return *this;
+    }
+    bool operator!=(const iterator &o) const { return s != o.s; }
+
+  private:
+    const ArduinoJsonShim::Slot *s;
+  };
+
+  JsonArrayConst(const ArduinoJsonShim::Slot *s = nullptr) : s(s && s->type == ArduinoJsonShim::J_ARRAY ? s : nullptr) {}
+  const ArduinoJsonShim::Slot *slot() const { return s; }
+  JsonVariantConst operator[](int index) const { return JsonVariantConst(ArduinoJsonShim::elementAt(s, index)); }
+  iterator begin() const { return iterator(s ? s->v.c.head : nullptr); }
+  iterator end() const { return iterator(nullptr); }
+  explicit operator bool() const { return s != nullptr; }
+
+private:
+  const ArduinoJsonShim::Slot *s;
+};
+
+/**
+ * @brief doc["key"] / obj["key"]: finds the member when read, adds it when
+ * written. Keys that are only read are never added.
+ */
+class MemberProxy : public JsonReadable<MemberProxy> {
+public:
+  MemberProxy(ArduinoJsonShim::Pool *pool, ArduinoJsonShim::Slot *obj, ArduinoJsonShim::Key key) : pool(pool), obj(obj), key(key) {}
+  const ArduinoJsonShim::Slot *slot() const { return ArduinoJsonShim::findMember(obj, key.str); }
+
+  template <typename T> MemberProxy &operator=(const T &value) {
+    ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+    if (s)
+      ArduinoJsonShim::setValue(pool, s, value);
+    return *this;
+  }
+  MemberProxy &operator=(char *value) { return assign(value); }
+  MemberProxy &operator=(const char *value) { return assign(value); }
+  MemberProxy &operator=(const MemberProxy &other) { return *this = JsonVariantConst(other.slot()); }
+  MemberProxy &operator=(JsonVariantConst value);
+
+  template <typename K> MemberProxy operator[](const K &k) {
+    ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+    return MemberProxy(pool, s, ArduinoJsonShim::makeKey(k));
+  }
+  template <typename K> JsonObject createNestedObject(const K &k);
+  template <typename K> JsonArray createNestedArray(const K &k);
+  template <typename T> T to();
+  operator JsonVariantConst() const { return JsonVariantConst(slot()); }
+  operator JsonVariant() const { return JsonVariant(pool, const_cast<ArduinoJsonShim::Slot *>(slot())); }
+
+private:
+  ArduinoJsonShim::Pool *pool;
+  ArduinoJsonShim::Slot *obj;
+  ArduinoJsonShim::Key key;
+
+  template <typename T> MemberProxy &assign(T value) {
+    ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+    if (s)
+      ArduinoJsonShim::setValue(pool, s, value);
+    return *this;
+  }
+};
+
+class JsonObject : public JsonReadable<JsonObject> {
+public:
+  JsonObject(ArduinoJsonShim::Pool *pool = nullptr, ArduinoJsonShim::Slot *s = nullptr)
+      : pool(pool), s(s && s->type == ArduinoJsonShim::J_OBJECT ? s : nullptr) {}
+  const ArduinoJsonShim::Slot *slot() const { return s; }
+
+  template <typename K> MemberProxy operator[](const K &key) const { return MemberProxy(pool, s, ArduinoJsonShim::makeKey(key)); }
+  MemberProxy operator[](char *key) const { return MemberProxy(pool, s, ArduinoJsonShim::makeKey(key)); }
+  MemberProxy operator[](const char *key) const { return MemberProxy(pool, s, ArduinoJsonShim::makeKey(key)); }
+  template <typename K> JsonObject createNestedObject(const K &key) const {
+    ArduinoJsonShim::Slot *m = ArduinoJsonShim::getOrAddMember(pool, s, ArduinoJsonShim::makeKey(key));
+    if (m == nullptr)
+      return JsonObject();
+    ArduinoJsonShim::makeContainer(m, ArduinoJsonShim::J_OBJECT);
+    return JsonObject(pool, m);
+  }
+  template <typename K> JsonArray createNestedArray(const K &key) const;
+  operator JsonObjectConst() const { return JsonObjectConst(s); }
+  operator JsonVariantConst() const { return JsonVariantConst(s); }
+  explicit operator bool() const { return s != nullptr; }
+
+private:
+  ArduinoJsonShim::Pool *pool;
+  ArduinoJsonShim::Slot *s;
+};
+
+class JsonArray : public JsonReadable<JsonArray> {
+public:
+  class iterator {
+  public:
+    iterator(ArduinoJsonShim::Pool *pool, ArduinoJsonShim::Slot *s) : pool(pool), s(s) {}
+    JsonVariant operator*() const { return JsonVariant(pool, s); }
+    iterator &operator++() {
+      s = s->next;
+      return *this;
+    }
+    bool operator!=(const iterator &o) const { return s != o.s; }
+
+  private:
+    ArduinoJsonShim::Pool *pool;
+    ArduinoJsonShim::Slot *s;
+  };
+
+  JsonArray(ArduinoJsonShim::Pool *pool = nullptr, ArduinoJsonShim::Slot *s = nullptr)
+      : pool(pool), s(s && s->type == ArduinoJsonShim::J_ARRAY ? s : nullptr) {}
+  const ArduinoJsonShim::Slot *slot() const { return s; }
+
+  template <typename T> bool add(const T &value) const {
+    ArduinoJsonShim::Slot *e = ArduinoJsonShim::addElement(pool, s);
+    return e && ArduinoJsonShim::setValue(pool, e, value);
+  }
+  bool add(char *value) const { return addValue(value); }
+  bool add(const char *value) const { return addValue(value); }
+  JsonObject createNestedObject() const {
+    ArduinoJsonShim::Slot *e = ArduinoJsonShim::addElement(pool, s);
+    if (e == nullptr)
+      return JsonObject();
+    ArduinoJsonShim::makeContainer(e, ArduinoJsonShim::J_OBJECT);
+    return JsonObject(pool, e);
+  }
+  JsonArray createNestedArray() const {
+    ArduinoJsonShim::Slot *e = ArduinoJsonShim::addElement(pool, s);
+    if (e == nullptr)
+      return JsonArray();
+    ArduinoJsonShim::makeContainer(e, ArduinoJsonShim::J_ARRAY);
+    return JsonArray(pool, e);
+  }
+  iterator begin() const { return iterator(pool, s ? s->v.c.head : nullptr); }
+  iterator end() const { return iterator(pool, nullptr); }
+  operator JsonArrayConst() const { return JsonArrayConst(s); }
+  operator JsonVariantConst() const { return JsonVariantConst(s); }
+  explicit operator bool() const { return s != nullptr; }
+
+private:
+  ArduinoJsonShim::Pool *pool;
+  ArduinoJsonShim::Slot *s;
+
+  template <typename T> bool addValue(T value) const {
+    ArduinoJsonShim::Slot *e = ArduinoJsonShim::addElement(pool, s);
+    return e && ArduinoJsonShim::setValue(pool, e, value);
+  }
+};
+
+template <typename K> JsonArray JsonObject::createNestedArray(const K &key) const {
+  ArduinoJsonShim::Slot *m = ArduinoJsonShim::getOrAddMember(pool, s, ArduinoJsonShim::makeKey(key));
+  if (m == nullptr)
+    return JsonArray();
+  ArduinoJsonShim::makeContainer(m, ArduinoJsonShim::J_ARRAY);
+  return JsonArray(pool, m);
+}
+
+template <typename K> JsonObject MemberProxy::createNestedObject(const K &k) {
+  ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+  return JsonObject(pool, s).createNestedObject(k);
+}
+
+template <typename K> JsonArray MemberProxy::createNestedArray(const K &k) {
+  ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+  return JsonObject(pool, s).createNestedArray(k);
+}
+
+// --- Conversions ---
+
+namespace ArduinoJsonShim {
+
+template <typename T> struct Converter {
+  static_assert(std::is_arithmetic<T>::value, "unsupported JSON conversion");
+
+  static T as(const Slot *s) {
+    if (s == nullptr)
+      return T();
+    if (std::is_integral<T>::value) {
+      switch (s->type) {
+      case J_INT:
+        return (T)s->v.i;
+      case J_UINT:
+        return (T)s->v.u;
+      case J_BOOL:
+        return (T)s->v.b;
+      case J_STRING:
+        return (T)strtoll(s->v.s, nullptr, 10);
+      default:
+        return (T)toDouble(s);
+      }
+    }
+    return (T)toDouble(s);
+  }
+  static bool is(const Slot *s) {
+    if (s == nullptr)
+      return false;
+    if (std::is_floating_point<T>::value)
+      return isNumber(s);
+    if (s->type == J_INT)
+      return s->v.i >= (int64_t)std::numeric_limits<T>::min() && (s->v.i < 0 || (uint64_t)s->v.i <= (uint64_t)std::numeric_limits<T>::max());
+    if (s->type == J_UINT)
+      return s->v.u <= (uint64_t)std::numeric_limits<T>::max();
+    return false;
+  }
+};
+
+template <> struct Converter<bool> {
+  static bool as(const Slot *s) {
+    if (s == nullptr)
+      return false;
+    switch (s->type) {
+    case J_NULL:
+      return false;
+    case J_BOOL:
+      return s->v.b;
+    case J_INT:
+    case J_UINT:
+    case J_FLOAT:
+      return toDouble(s) != 0;
+    default:
+      return true;
+    }
+  }
+  static bool is(const Slot *s) { return s && s->type == J_BOOL; }
+};
+
+template <> struct Converter<const char *> {
+  static const char *as(const Slot *s) { return s && s->type == J_STRING ? s->v.s : nullptr; }
+  static bool is(const Slot *s) { return s && s->type == J_STRING; }
+};
+
+template <> struct Converter<String> {
+  static String as(const Slot *s) { return String(Converter<const char *>::as(s) ?: "null"); }
+  static bool is(const Slot *s) { return s && s->type == J_STRING; }
+};
+
+template <> struct Converter<JsonVariantConst> {
+  static JsonVariantConst as(const Slot *s) { return JsonVariantConst(s); }
+  static bool is(const Slot *) { return true; }
+};
+
+template <> struct Converter<JsonObjectConst> {
+  static JsonObjectConst as(const Slot *s) { return JsonObjectConst(s); }
+  static bool is(const Slot *s) { return s && s->type == J_OBJECT; }
+};
+
+template <> struct Converter<JsonArrayConst> {
+  static JsonArrayConst as(const Slot *s) { return JsonArrayConst(s); }
+  static bool is(const Slot *s) { return s && s->type == J_ARRAY; }
+};
+
+// Zmienne referencje potrzebują puli, więc tylko is<>() jest tu wspólne
+template <> struct Converter<JsonObject> {
+  static bool is(const Slot *s) { return s && s->type == J_OBJECT; }
+};
+template <> struct Converter<JsonArray> {
+  static bool is(const Slot *s) { return s && s->type == J_ARRAY; }
+};
+
+} // namespace ArduinoJsonShim
+
+inline MemberProxy &MemberProxy::operator=(JsonVariantConst value) {
+  using namespace ArduinoJsonShim;
+  const Slot *src = value.slot();
+  Slot *s = getOrAddMember(pool, obj, key);
+  if (s == nullptr)
+    return *this;
+  if (src == nullptr || src->type == J_OBJECT || src->type == J_ARRAY)
+    s->type = J_NULL; // głębokie kopie nie są potrzebne w firmware
+  else if (src->type == J_STRING)
+    setCopy(pool, s, src->v.s, strlen(src->v.s));
+  else
+    *s = Slot{s->next, s->key, src->type, src->v};
+  return *this;
+}
+
+template <> inline JsonObject MemberProxy::to<JsonObject>() {
+  ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+  if (s == nullptr)
+    return JsonObject();
+  ArduinoJsonShim::makeContainer(s, ArduinoJsonShim::J_OBJECT);
+  return JsonObject(pool, s);
+}
+
+template <> inline JsonArray MemberProxy::to<JsonArray>() {
+  ArduinoJsonShim::Slot *s = ArduinoJsonShim::getOrAddMember(pool, obj, key);
+  if (s == nullptr)
+    return JsonArray();
+  ArduinoJsonShim::makeContainer(s, ArduinoJsonShim::J_ARRAY);
+  return JsonArray(pool, s);
+}
+
+// --- Documents ---
+
+class JsonDocument {
+public:
+  JsonDocument(const JsonDocument &) = delete;
+  JsonDocument &operator=(const JsonDocument &) = delete;
+  virtual ~JsonDocument() { pool.release(); }
+
+  size_t capacity() const { return pool.cap; }
+  size_t memoryUsage() const { return pool.espUsed; }
+  bool overflowed() const { return pool.overflow; }
+  void clear() {
+    pool.clear();
+    root = ArduinoJsonShim::Slot();
+  }
+  bool isNull() const { return root.type == ArduinoJsonShim::J_NULL; }
+  size_t size() const { return ArduinoJsonShim::childCount(&root); }
+
+  template <typename T> T to();
+  template <typename T> T as();
+  template <typename T> T as() const;
+  template <typename T> bool is() const { return ArduinoJsonShim::Converter<T>::is(&root); }
+
+  template <typename K> MemberProxy operator[](const K &key) { return MemberProxy(&pool, &root, ArduinoJsonShim::makeKey(key)); }
+  MemberProxy operator[](char *key) { return MemberProxy(&pool, &root, ArduinoJsonShim::makeKey(key)); }
+  MemberProxy operator[](const char *key) { return MemberProxy(&pool, &root, ArduinoJsonShim::makeKey(key)); }
+  template <typename K> JsonVariantConst operator[](const K &key) const {
+    return JsonVariantConst(ArduinoJsonShim::findMember(&root, ArduinoJsonShim::makeKey(key).str));
+  }
+  template <typename K> bool containsKey(const K &key) const { return ArduinoJsonShim::findMember(&root, ArduinoJsonShim::makeKey(key).str) != nullptr; }
+
+  template <typename K> JsonObject createNestedObject(const K &key) { return rootObject().createNestedObject(key); }
+  template <typename K> JsonArray createNestedArray(const K &key) { return rootObject().createNestedArray(key); }
+  template <typename T> bool add(const T &value) { return rootArray().add(value); }
+  JsonObject createNestedObject() { return rootArray().createNestedObject(); }
+
+  const ArduinoJsonShim::Slot *slot() const { return &root; }
+  ArduinoJsonShim::Pool *memoryPool() { return &pool; }
+  ArduinoJsonShim::Slot *rootSlot() { return &root; }
+  operator JsonVariantConst() const { return JsonVariantConst(&root); }
+
+protected:
+  JsonDocument(size_t capacity) { pool.init(capacity); }
+
+private:
+  ArduinoJsonShim::Pool pool;
+  ArduinoJsonShim::Slot root = ArduinoJsonShim::Slot();
+
+  JsonObject rootObject() {
+    if (root.type == ArduinoJsonShim::J_NULL)
+      ArduinoJsonShim::makeContainer(&root, ArduinoJsonShim::J_OBJECT);
+    return JsonObject(&pool, &root);
+  }
+  JsonArray rootArray() {
+    if (root.type == ArduinoJsonShim::J_NULL)
+      ArduinoJsonShim::makeContainer(&root, ArduinoJsonShim::J_ARRAY);
+    return JsonArray(&pool, &root);
+  }
+};
+
+template <> inline JsonObject JsonDocument::to<JsonObject>() {
+  clear();
+  ArduinoJsonShim::makeContainer(&root, ArduinoJsonShim::J_OBJECT);
+  return JsonObject(&pool, &root);
+}
+template <> inline JsonArray JsonDocument::to<JsonArray>() {
+  clear();
+  ArduinoJsonShim::makeContainer(&root, ArduinoJsonShim::J_ARRAY);
+  return JsonArray(&pool, &root);
+}
+template <> inline JsonObject JsonDocument::as<JsonObject>() { return JsonObject(&pool, &root); }
+template <> inline JsonArray JsonDocument::as<JsonArray>() { return JsonArray(&pool, &root); }
+template <typename T> T JsonDocument::as() { return ArduinoJsonShim::Converter<T>::as(&root); }
+template <typename T> T JsonDocument::as() const { return ArduinoJsonShim::Converter<T>::as(&root); }
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+  /** Takes the capacity from the heap, like the real one (counted by the bench). */
+  explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity), footprint(malloc(capacity)) {}
+  ~DynamicJsonDocument() { free(footprint); }
+
+private:
+  void *footprint;
+};
+
+template <size_t N> class StaticJsonDocument : public JsonDocument {
+public:
+  StaticJsonDocument() : JsonDocument(N) {}
+
+private:
+  uint8_t footprint[N]; // rozmiar obiektu jak na ESP
+};
+
+// --- Serialization ---
+
+namespace ArduinoJsonShim {
+
+class Writer {
+public:
+  virtual ~Writer() {}
+  virtual void write(const char *s, size_t n) = 0;
+  void write(const char *s) { write(s, strlen(s)); }
+  void write(char c) { write(&c, 1); }
+  size_t count = 0;
+};
+
+class PrintWriter : public Writer {
+public:
+  PrintWriter(Print &out) : out(out) {}
+  void write(const char *s, size_t n) override { count += out.write((const uint8_t *)s, n); }
+  using Writer::write;
+
+private:
+  Print &out;
+};
+
+/** @brief Appends in 32-byte steps, like ArduinoJson's String writer. */
+class StringWriter : public Writer {
+public:
+  StringWriter(String &out) : out(out) {}
+  ~StringWriter() { flush(); }
+  void write(const char *s, size_t n) override {
+    for (size_t i = 0; i < n; i++) {
+      if (used == sizeof(buffer))
+        flush();
+      buffer[used++] = s[i];
+    }
+    count += n;
+  }
+  using Writer::write;
+  void flush() {
+    out.concat(buffer, used);
+    used = 0;
+  }
+
+private:
+  String &out;
+  char buffer[32];
+  size_t used = 0;
+};
+
+class BufferWriter : public Writer {
+public:
+  BufferWriter(char *buf, size_t size) : buf(buf), size(size) {}
+  void write(const char *s, size_t n) override {
+    size_t room = size > count + 1 ? size - count - 1 : 0;
+    n = n < room ? n : room;
+    memcpy(buf + count, s, n);
+    count += n;
+  }
+  using Writer::write;
+
+private:
+  char *buf;
+  size_t size;
+};
+
+class CountingWriter : public Writer {
+public:
+  void write(const char *, size_t n) override { count += n; }
+  using Writer::write;
+};
+
+inline void writeString(Writer &w, const char *s) {
+  w.write('"');
+  for (; *s; s++) {
+    switch (*s) {
+    case '"':
+      w.write("\\\"");
+      break;
+    case '\\':
+      w.write("\\\\");
+      break;
+    case '\b':
+      w.write("\\b");
+      break;
+    case '\f':
+      w.write("\\f");
+      break;
+    case '\n':
+      w.write("\\n");
+      break;
+    case '\r':
+      w.write("\\r");
+      break;
+    case '\t':
+      w.write("\\t");
+      break;
+    default:
+      w.write(*s);
+    }
+  }
+  w.write('"');
+}
+
+inline void writeIndent(Writer &w, int depth) {
+  w.write("\r\n");
+  for (int i = 0; i < depth; i++)
+    w.write("  ");
+}
+
+inline void writeValue(Writer &w, const Slot *s, bool pretty, int depth) {
+  char b[32];
+  switch (s ? s->type : J_NULL) {
+  case J_NULL:
+    w.write("null");
+    break;
+  case J_BOOL:
+    w.write(s->v.b ? "true" : "false");
+    break;
+  case J_INT:
+    snprintf(b, sizeof(b), "%lld", (long long)s->v.i);
+    w.write(b);
+    break;
+  case J_UINT:
+    snprintf(b, sizeof(b), "%llu", (unsigned long long)s->v.u);
+    w.write(b);
+    break;
+  case J_FLOAT:
+    if (isnan(s->v.f) || isinf(s->v.f))
+      w.write("null");
+    else {
+      snprintf(b, sizeof(b), "%.9g", s->v.f);
+      w.write(b);
+    }
+    break;
+  case J_STRING:
+    writeString(w, s->v.s);
+    break;
+  case J_OBJECT:
+  case J_ARRAY: {
+    bool object = s->type == J_OBJECT;
+    w.write(object ? '{' : '[');
+    for (const Slot *c = s->v.c.head; c; c = c->next) {
+      if (pretty)
+        writeIndent(w, depth + 1);
+      if (object) {
+        writeString(w, c->key);
+        w.write(pretty ? ": " : ":");
+      }
+      writeValue(w, c, pretty, depth + 1);
+      if (c->next)
+        w.write(',');
+    }
+    if (pretty && s->v.c.head)
+      writeIndent(w, depth);
+    w.write(object ? '}' : ']');
+    break;
+  }
+  }
+}
+
+// --- Deserialization ---
+
+class Reader {
+public:
+  virtual ~Reader() {}
+  virtual int peek() = 0;
+  virtual int read() = 0;
+};
+
+class MemoryReader : public Reader {
+public:
+  MemoryReader(const char *p, const char *end) : p(p), end(end) {}
+  int peek() override { return p < end && *p ? (uint8_t)*p : -1; }
+  int read() override { return p < end && *p ? (uint8_t)*p++ : -1; }
+
+private:
+  const char *p;
+  const char *end;
+};
+
+class StreamReader : public Reader {
+public:
+  StreamReader(Stream &in) : in(in) {}
+  int peek() override { return in.peek(); }
+  int read() override { return in.read(); }
+
+private:
+  Stream &in;
+};
+
+} // namespace ArduinoJsonShim
+
+class DeserializationError {
+public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+  DeserializationError(Code code = Ok) : errorCode(code) {}
+  explicit operator bool() const { return errorCode != Ok; }
+  bool operator==(Code c) const { return errorCode == c; }
+  bool operator!=(Code c) const { return errorCode != c; }
+  Code code() const { return errorCode; }
+  const char *c_str() const {
+    static const char *const names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+    return names[errorCode];
+  }
+
+private:
+  Code errorCode;
+};
+
+namespace ArduinoJsonShim {
+
+class Parser {
+public:
+  Parser(Pool *pool, Reader &in, bool zeroCopy) : pool(pool), in(in), zeroCopy(zeroCopy) {}
+
+  DeserializationError parse(Slot *root) {
+    skipSpace();
+    if (in.peek() < 0)
+      return DeserializationError::EmptyInput;
+    return parseValue(root, 0);
+  }
+
+private:
+  Pool *pool;
+  Reader &in;
+  bool zeroCopy;
+  std::string text; // bufor roboczy parsera (na ESP: wejście albo pula)
+
+  void skipSpace() {
+    while (in.peek() >= 0 && isspace(in.peek()))
+      in.read();
+  }
+
+  DeserializationError parseValue(Slot *s, int depth) {
+    skipSpace();
+    int c = in.peek();
+    if (c < 0)
+      return DeserializationError::IncompleteInput;
+    if (c == '{' || c == '[')
+      return depth >= 10 ? DeserializationError::TooDeep : parseContainer(s, c == '{', depth);
+    if (c == '"' || c == '\'') {
+      DeserializationError e = parseString();
+      if (e)
+        return e;
+      const char *p = zeroCopy ? pool->keepString(text.data(), text.size()) : pool->copyString(text.data(), text.size());
+      if (p == nullptr)
+        return DeserializationError::NoMemory;
+      s->type = J_STRING;
+      s->v.s = p;
+      return DeserializationError::Ok;
+    }
+    text.clear();
+    while (in.peek() >= 0 && (isalnum(in.peek()) || strchr("+-.", in.peek())))
+      text += (char)in.read();
+    if (text.empty())
+      return DeserializationError::InvalidInput;
+    if (text == "true" || text == "false")
+      setValue(pool, s, text == "true");
+    else if (text == "null")
+      s->type = J_NULL;
+    else {
+      char *end;
+      if (text.find_first_of(".eE") == std::string::npos) {
+        errno = 0;
+        if (text[0] == '-') {
+          long long v = strtoll(text.c_str(), &end, 10);
+          if (*end == 0 && errno == 0)
+            return setValue(pool, s, (int64_t)v), DeserializationError::Ok;
+        } else {
+          unsigned long long v = strtoull(text.c_str(), &end, 10);
+          if (*end == 0 && errno == 0)
+            return setValue(pool, s, (uint64_t)v), DeserializationError::Ok;
+        }
+      }
+      double v = strtod(text.c_str(), &end);
+      if (*end != 0)
+        return DeserializationError::InvalidInput;
+      setValue(pool, s, v);
+    }
+    return DeserializationError::Ok;
+  }
+
+  DeserializationError parseString() {
+    int quote = in.read();
+    text.clear();
+    for (;;) {
+      int c = in.read();
+      if (c < 0)
+        return DeserializationError::IncompleteInput;
+      if (c == quote)
+        return DeserializationError::Ok;
+      if (c == '\\') {
+        c = in.read();
+        switch (c) {
+        case -1:
+          return DeserializationError::IncompleteInput;
+        case 'b':
+          c = '\b';
+          break;
+        case 'f':
+          c = '\f';
+          break;
+        case 'n':
+          c = '\n';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'u': {
+          unsigned code = 0;
+          for (int i = 0; i < 4; i++) {
+            int h = in.read();
+            if (h < 0)
+              return DeserializationError::IncompleteInput;
+            if (!isxdigit(h))
+              return DeserializationError::InvalidInput;
+            code = code * 16 + (isdigit(h) ? h - '0' : (tolower(h) - 'a' + 10));
+          }
+          if (code < 0x80)
+            text += (char)code;
+          else if (code < 0x800) {
+            text += (char)(0xC0 | code >> 6);
+            text += (char)(0x80 | (code & 0x3F));
+          } else {
+            text += (char)(0xE0 | code >> 12);
+            text += (char)(0x80 | (code >> 6 & 0x3F));
+            text += (char)(0x80 | (code & 0x3F));
+          }
+          continue;
+        }
+        }
+      }
+      text += (char)c;
+    }
+  }
+
+  DeserializationError parseContainer(Slot *s, bool object, int depth) {
+    in.read();
+    makeContainer(s, object ? J_OBJECT : J_ARRAY);
+    skipSpace();
+    if (in.peek() == (object ? '}' : ']')) {
+      in.read();
+      return DeserializationError::Ok;
+    }
+    for (;;) {
+      Slot *child = addChild(pool, s);
+      if (child == nullptr)
+        return DeserializationError::NoMemory;
+      if (object) {
+        skipSpace();
+        if (in.peek() < 0)
+          return DeserializationError::IncompleteInput;
+        if (in.peek() != '"' && in.peek() != '\'')
+          return DeserializationError::InvalidInput;
+        DeserializationError e = parseString();
+        if (e)
+          return e;
+        child->key = zeroCopy ? pool->keepString(text.data(), text.size()) : pool->copyString(text.data(), text.size());
+        if (child->key == nullptr)
+          return DeserializationError::NoMemory;
+        skipSpace();
+        int colon = in.read();
+        if (colon != ':')
+          return colon < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      }
+      DeserializationError e = parseValue(child, depth + 1);
+      if (e)
+        return e;
+      skipSpace();
+      int c = in.read();
+      if (c == (object ? '}' : ']'))
+        return DeserializationError::Ok;
+      if (c != ',')
+        return c < 0 ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    }
+  }
+};
+
+inline DeserializationError deserialize(JsonDocument &doc, Reader &in, bool zeroCopy) {
+  doc.clear();
+  Parser parser(doc.memoryPool(), in, zeroCopy);
+  DeserializationError e = parser.parse(doc.rootSlot());
+  if (e)
+    doc.clear();
+  return e;
+}
+
+} // namespace ArduinoJsonShim
+
+template <typename TSource> size_t serializeJson(const TSource &src, char *output, size_t size) {
+  ArduinoJsonShim::BufferWriter w(output, size);
+  ArduinoJsonShim::writeValue(w, src.slot(), false, 0);
+  if (size > 0)
+    output[w.count] = 0;
+  return w.count;
+}
+template <typename TSource> size_t serializeJson(const TSource &src, String &output) {
+  ArduinoJsonShim::StringWriter w(output);
+  ArduinoJsonShim::writeValue(w, src.slot(), false, 0);
+  w.flush();
+  return w.count;
+}
+template <typename TSource> size_t serializeJson(const TSource &src, Print &output) {
+  ArduinoJsonShim::PrintWriter w(output);
+  ArduinoJsonShim::writeValue(w, src.slot(), false, 0);
+  return w.count;
+}
+template <typename TSource> size_t serializeJsonPretty(const TSource &src, char *output, size_t size) {
+  ArduinoJsonShim::BufferWriter w(output, size);
+  ArduinoJsonShim::writeValue(w, src.slot(), true, 0);
+  if (size > 0)
+    output[w.count] = 0;
+  return w.count;
+}
+template <typename TSource> size_t serializeJsonPretty(const TSource &src, String &output) {
+  ArduinoJsonShim::StringWriter w(output);
+  ArduinoJsonShim::writeValue(w, src.slot(), true, 0);
+  w.flush();
+  return w.count;
+}
+template <typename TSource> size_t serializeJsonPretty(const TSource &src, Print &output) {
+  ArduinoJsonShim::PrintWriter w(output);
+  ArduinoJsonShim::writeValue(w, src.slot(), true, 0);
+  return w.count;
+}
+template <typename TSource> size_t measureJson(const TSource &src) {
+  ArduinoJsonShim::CountingWriter w;
+  ArduinoJsonShim::writeValue(w, src.slot(), false, 0);
+  return w.count;
+}
+template <typename TSource> size_t measureJsonPretty(const TSource &src) {
+  ArduinoJsonShim::CountingWriter w;
+  ArduinoJsonShim::writeValue(w, src.slot(), true, 0);
+  return w.count;
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t length) {
+  ArduinoJsonShim::MemoryReader r(input, input + length);
+  return ArduinoJsonShim::deserialize(doc, r, false);
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, char *input, size_t length) {
+  ArduinoJsonShim::MemoryReader r(input, input + length);
+  return ArduinoJsonShim::deserialize(doc, r, true);
+}
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input) { return deserializeJson(doc, input, strlen(input)); }
+inline DeserializationError deserializeJson(JsonDocument &doc, char *input) { return deserializeJson(doc, input, strlen(input)); }
+inline DeserializationError deserializeJson(JsonDocument &doc, const String &input) { return deserializeJson(doc, input.c_str(), input.length()); }
+inline DeserializationError deserializeJson(JsonDocument &doc, Stream &input) {
+  ArduinoJsonShim::StreamReader r(input);
+  return ArduinoJsonShim::deserialize(doc, r, false);
+}
+
+#endif // BENCH_ARDUINOJSON_H
@@ -0,0 +1,17 @@
+/** Host stand-in for ArduinoOTA (never receives an update). */
+#ifndef BENCH_ARDUINOOTA_H
+#define BENCH_ARDUINOOTA_H
+#include <Arduino.h>
+typedef enum { OTA_AUTH_ERROR, OTA_BEGIN_ERROR, OTA_CONNECT_ERROR, OTA_RECEIVE_ERROR, OTA_END_ERROR } ota_error_t;
+class ArduinoOTAClass {
+public:
+  void setHostname(const char *) {}
+  void onStart(std::function<void()>) {}
+  void onEnd(std::function<void()>) {}
+  void onProgress(std::function<void(unsigned int, unsigned int)>) {}
+  void onError(std::function<void(ota_error_t)>) {}
+  void begin() {}
+  void handle() {}
+};
+extern ArduinoOTAClass ArduinoOTA;
+#endif
@@ -0,0 +1,2 @@
+/** Host stand-in for AsyncWebSocket (see ESPAsyncWebServer.h). */
+#include <ESPAsyncWebServer.h>
@@ -0,0 +1,10 @@
+/** Host stand-in for DNSServer (captive portal). */
+#ifndef BENCH_DNSSERVER_H
+#define BENCH_DNSSERVER_H
+#include <IPAddress.h>
+class DNSServer {
+public:
+  bool start(uint16_t, const char *, IPAddress) { return true; }
+  void processNextRequest() {}
+};
+#endif
@@ -0,0 +1,10 @@
+/** Host stand-in for ESP8266NetBIOS. */
+#ifndef BENCH_ESP8266NETBIOS_H
+#define BENCH_ESP8266NETBIOS_H
+#include <Arduino.h>
+class ESP8266NetBIOS {
+public:
+  bool begin(const char *) { return true; }
+};
+extern ESP8266NetBIOS NBNS;
+#endif
@@ -0,0 +1,21 @@
+/** Host stand-in for ESP8266SSDP. */
+#ifndef BENCH_ESP8266SSDP_H
+#define BENCH_ESP8266SSDP_H
+#include <Arduino.h>
+class SSDPClass {
+public:
+  void setSchemaURL(const char *) {}
+  void setHTTPPort(uint16_t) {}
+  void setName(const char *) {}
+  void setSerialNumber(const char *) {}
+  void setURL(const char *) {}
+  void setModelName(const __FlashStringHelper *) {}
+  void setModelNumber(const char *) {}
+  void setManufacturer(const __FlashStringHelper *) {}
+  void setManufacturerURL(const __FlashStringHelper *) {}
+  void setDeviceType(const char *) {}
+  bool begin() { return true; }
+  void schema(Print &out) { out.print("<?xml version=\"1.0\"?><root/>"); }
+};
+extern SSDPClass SSDP;
+#endif
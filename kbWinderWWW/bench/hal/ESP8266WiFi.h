@@ -0,0 +1,66 @@
+/**
+ * Host stand-in for ESP8266WiFi: a station that is always connected.
+ */
+
+#ifndef BENCH_ESP8266WIFI_H
+#define BENCH_ESP8266WIFI_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+enum WiFiMode_t { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 };
+enum WiFiSleepType_t { WIFI_NONE_SLEEP = 0, WIFI_LIGHT_SLEEP = 1, WIFI_MODEM_SLEEP = 2 };
+enum wl_status_t { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 };
+enum wl_enc_type { AUTH_OPEN = 0, AUTH_WPA2_PSK = 3 };
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+class ESP8266WiFiClass {
+public:
+  WiFiMode_t currentMode = WIFI_AP_STA;
+  String apSsid = "kbWinder-bench";
+  String staSsid = "bench";
+
+  bool mode(WiFiMode_t m) { return currentMode = m, true; }
+  WiFiMode_t getMode() { return currentMode; }
+  bool persistent(bool) { return true; }
+  bool setSleepMode(WiFiSleepType_t) { return true; }
+  void setOutputPower(float) {}
+  bool hostname(const char *) { return true; }
+  String macAddress() { return "5C:CF:7F:00:BE:0C"; }
+  uint8_t *macAddress(uint8_t *mac) {
+    static const uint8_t bench[6] = {0x5C, 0xCF, 0x7F, 0x00, 0xBE, 0x0C};
+    memcpy(mac, bench, 6);
+    return mac;
+  }
+
+  bool softAPdisconnect(bool) { return true; }
+  bool softAPConfig(IPAddress, IPAddress, IPAddress) { return true; }
+  bool softAP(const char *ssid, const char *) { return apSsid = ssid, true; }
+  String softAPSSID() { return apSsid; }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress()) { return true; }
+  wl_status_t begin(const char *ssid, const char *) { return staSsid = ssid, WL_CONNECTED; }
+  bool disconnect(bool = false) { return true; }
+  wl_status_t status() { return WL_CONNECTED; }
+  String SSID() { return staSsid; }
+  int32_t RSSI() { return -60; }
+  IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+  IPAddress gatewayIP() { return IPAddress(192, 168, 1, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+  IPAddress dnsIP() { return IPAddress(192, 168, 1, 1); }
+
+  int8_t scanNetworks(bool, bool) { return WIFI_SCAN_RUNNING; }
+  int8_t scanComplete() { return 0; }
+  void scanDelete() {}
+  String SSID(uint8_t) { return staSsid; }
+  int32_t RSSI(uint8_t) { return -60; }
+  uint8_t encryptionType(uint8_t) { return AUTH_WPA2_PSK; }
+  int32_t channel(uint8_t) { return 6; }
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif // BENCH_ESP8266WIFI_H
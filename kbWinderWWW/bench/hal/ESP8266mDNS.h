@@ -0,0 +1,12 @@
+/** Host stand-in for ESP8266mDNS. */
+#ifndef BENCH_ESP8266MDNS_H
+#define BENCH_ESP8266MDNS_H
+#include <Arduino.h>
+class MDNSResponder {
+public:
+  bool begin(const char *) { return true; }
+  void addService(const char *, const char *, uint16_t) {}
+  void update() {}
+};
+extern MDNSResponder MDNS;
+#endif
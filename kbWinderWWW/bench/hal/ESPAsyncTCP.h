@@ -0,0 +1,2 @@
+/** Host stand-in for ESPAsyncTCP (see ESPAsyncWebServer.h). */
+#include <ESPAsyncWebServer.h>
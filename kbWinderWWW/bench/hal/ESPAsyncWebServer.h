@@ -0,0 +1,337 @@
+/**
+ * Host stand-in for ESPAsyncWebServer / AsyncWebSocket.
+ *
+ * Routes are recorded so the bench can dispatch fake requests to them.
+ * Responses are completed synchronously: chunked fillers are drained at
+ * send() in TCP-sized pieces. WebSocket clients have a bench-controlled
+ * send window, so slow clients can be modelled; the library's own message
+ * buffers are not allocated (only the firmware's heap use is measured).
+ */
+
+#ifndef BENCH_ESPASYNCWEBSERVER_H
+#define BENCH_ESPASYNCWEBSERVER_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <LittleFS.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef uint8_t WebRequestMethodComposite;
+enum WebRequestMethod : uint8_t { HTTP_GET = 0x01, HTTP_POST = 0x02, HTTP_DELETE = 0x04, HTTP_PUT = 0x08, HTTP_ANY = 0xFF };
+
+class AsyncWebServerRequest;
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+
+typedef std::function<void(AsyncWebServerRequest *)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *, const String &, size_t, uint8_t *, size_t, bool)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *, uint8_t *, size_t, size_t, size_t)> ArBodyHandlerFunction;
+typedef std::function<size_t(uint8_t *, size_t, size_t)> AwsResponseFiller;
+
+// --- Responses ---
+
+class AsyncWebServerResponse {
+public:
+  int code;
+  String contentType;
+  std::vector<std::pair<String, String>> headers;
+  std::string body;
+  AwsResponseFiller filler;
+
+  AsyncWebServerResponse(int code = 200, const String &contentType = String()) : code(code), contentType(contentType) {}
+  virtual ~AsyncWebServerResponse() {}
+  void setCode(int c) { code = c; }
+  void addHeader(const String &name, const String &value) { headers.emplace_back(name, value); }
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+  using AsyncWebServerResponse::AsyncWebServerResponse;
+  size_t write(uint8_t c) override {
+    body += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buf, size_t n) override {
+    body.append((const char *)buf, n);
+    return n;
+  }
+  using Print::write;
+};
+
+class DefaultHeaders {
+public:
+  static DefaultHeaders &Instance() {
+    static DefaultHeaders instance;
+    return instance;
+  }
+  void addHeader(const String &, const String &) {}
+};
+
+// --- Requests ---
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String &name, const String &value) : paramName(name), paramValue(value) {}
+  const String &name() const { return paramName; }
+  const String &value() const { return paramValue; }
+
+private:
+  String paramName;
+  String paramValue;
+};
+
+class AsyncClient {
+public:
+  IPAddress remoteIP() const { return IPAddress(192, 168, 1, 10); }
+};
+
+class AsyncWebServerRequest {
+public:
+  String requestUrl;
+  WebRequestMethodComposite requestMethod = HTTP_GET;
+  std::vector<AsyncWebParameter> params;
+  std::vector<std::pair<String, String>> requestHeaders;
+  AsyncWebServerResponse *response = nullptr; ///< Last response sent
+  size_t chunkSize = 1460;                    ///< Filler calls use this much
+  size_t largestChunk = 0;
+  AsyncClient tcp;
+
+  AsyncWebServerRequest(const String &url, WebRequestMethodComposite method = HTTP_GET) : requestUrl(url), requestMethod(method) {}
+  ~AsyncWebServerRequest() { delete response; }
+
+  const String &url() const { return requestUrl; }
+  WebRequestMethodComposite method() const { return requestMethod; }
+  AsyncClient *client() { return &tcp; }
+
+  void addParam(const String &name, const String &value) { params.emplace_back(name, value); }
+  bool hasParam(const String &name, bool = false, bool = false) const { return getParamConst(name) != nullptr; }
+  AsyncWebParameter *getParam(const String &name, bool = false, bool = false) { return const_cast<AsyncWebParameter *>(getParamConst(name)); }
+  bool hasArg(const char *name) const { return hasParam(name); }
+  const String &arg(const String &name) const {
+    static const String empty;
+    const AsyncWebParameter *p = getParamConst(name);
+    return p ? p->value() : empty;
+  }
+  bool hasHeader(const String &name) const {
+    for (auto const &h : requestHeaders) {
+      if (h.first == name)
+        return true;
+    }
+    return false;
+  }
+  String header(const char *name) const {
+    for (auto const &h : requestHeaders) {
+      if (h.first == name)
+        return h.second;
+    }
+    return String();
+  }
+
+  bool authenticate(const char *, const char *) { return true; }
+  void requestAuthentication() { send(401); }
+  void redirect(const String &url) {
+    AsyncWebServerResponse *r = beginResponse(302);
+    r->addHeader("Location", url);
+    send(r);
+  }
+
+  AsyncWebServerResponse *beginResponse(int code, const String &contentType = String(), const String &content = String()) {
+    AsyncWebServerResponse *r = new AsyncWebServerResponse(code, contentType);
+    r->body.assign(content.c_str(), content.length());
+    return r;
+  }
+  AsyncWebServerResponse *beginResponse(FS &fs, const String &path, const String &contentType = String(), bool = false) {
+    return beginResponse(fs.open(path, "r"), path, contentType);
+  }
+  AsyncWebServerResponse *beginResponse(File file, const String &, const String &contentType = String(), bool = false) {
+    AsyncWebServerResponse *r = new AsyncWebServerResponse(file ? 200 : 404, contentType);
+    for (int c; (c = file.read()) >= 0;)
+      r->body += (char)c;
+    return r;
+  }
+  AsyncResponseStream *beginResponseStream(const String &contentType, size_t = 1460) { return new AsyncResponseStream(200, contentType); }
+  AsyncWebServerResponse *beginChunkedResponse(const String &contentType, AwsResponseFiller filler) {
+    AsyncWebServerResponse *r = new AsyncWebServerResponse(200, contentType);
+    r->filler = filler;
+    return r;
+  }
+
+  void send(AsyncWebServerResponse *r) {
+    if (r->filler) {
+      std::vector<uint8_t> chunk(chunkSize);
+      for (size_t index = 0;;) {
+        size_t n = r->filler(chunk.data(), chunk.size(), index);
+        if (n == 0)
+          break;
+        largestChunk = max(largestChunk, n);
+        r->body.append((const char *)chunk.data(), n);
+        index += n;
+      }
+      r->filler = nullptr; // frees what the filler captured, as the library does
+    }
+    delete response;
+    response = r;
+  }
+  void send(int code, const String &contentType = String(), const String &content = String()) {
+    send(beginResponse(code, contentType, content));
+  }
+  void send(FS &fs, const String &path, const String &contentType = String(), bool download = false) {
+    send(beginResponse(fs, path, contentType, download));
+  }
+
+private:
+  const AsyncWebParameter *getParamConst(const String &name) const {
+    for (auto const &p : params) {
+      if (p.name() == name)
+        return &p;
+    }
+    return nullptr;
+  }
+};
+
+// --- Server ---
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() {}
+};
+
+class AsyncWebServer {
+public:
+  struct Route {
+    String uri;
+    WebRequestMethodComposite method;
+    ArRequestHandlerFunction onRequest;
+    ArBodyHandlerFunction onBody;
+  };
+  std::vector<Route> routes;
+  ArRequestHandlerFunction notFound;
+
+  AsyncWebServer(uint16_t) {}
+  void begin() {}
+  void addHandler(AsyncWebHandler *) {}
+  void onNotFound(ArRequestHandlerFunction handler) { notFound = handler; }
+  void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest) { routes.push_back({uri, method, onRequest, nullptr}); }
+  void on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest, ArUploadHandlerFunction,
+          ArBodyHandlerFunction onBody) {
+    routes.push_back({uri, method, onRequest, onBody});
+  }
+
+  /** @brief Runs a request through the matching route (bench only). */
+  void dispatch(AsyncWebServerRequest *request, const uint8_t *body = nullptr, size_t bodyLength = 0, size_t bodyChunk = 536) {
+    for (auto const &route : routes) {
+      if (route.uri != request->url() || !(route.method & request->method()))
+        continue;
+      if (route.onBody) {
+        for (size_t index = 0; index < bodyLength; index += bodyChunk) {
+          size_t n = min(bodyChunk, bodyLength - index);
+          route.onBody(request, const_cast<uint8_t *>(body) + index, n, index, bodyLength);
+        }
+      }
+      if (request->response == nullptr)
+        route.onRequest(request);
+      return;
+    }
+    if (notFound)
+      notFound(request);
+  }
+};
+
+// --- WebSocket ---
+
+enum AwsClientStatus { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING };
+enum AwsEventType { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA };
+
+typedef std::function<void(AsyncWebSocket *, AsyncWebSocketClient *, AwsEventType, void *, uint8_t *, size_t)> AwsEventHandler;
+
+class AsyncWebSocketClient {
+public:
+  uint32_t clientId;
+  AwsClientStatus clientStatus = WS_CONNECTED;
+  size_t window = 8;   ///< Messages the TCP side takes before canSend() is false
+  size_t inFlight = 0; ///< Sent, not yet drained by the bench
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  bool capture = false; ///< Keep text payloads in "received" (fuzzing)
+  std::vector<std::string> received;
+
+  AsyncWebSocketClient(uint32_t id) : clientId(id) {}
+  uint32_t id() const { return clientId; }
+  AwsClientStatus status() const { return clientStatus; }
+  IPAddress remoteIP() const { return IPAddress(192, 168, 1, 10); }
+  bool canSend() const { return clientStatus == WS_CONNECTED && inFlight < window; }
+  void close() { clientStatus = WS_DISCONNECTING; }
+
+  void text(const char *message, size_t length) {
+    if (capture)
+      received.emplace_back(message, length);
+    queued(length);
+  }
+  void text(const char *message) { text(message, strlen(message)); }
+  void text(const String &message) { text(message.c_str(), message.length()); }
+  void binary(const uint8_t *, size_t length) { queued(length); }
+
+  /** @brief The network took everything that was in flight (bench only). */
+  void drain() { inFlight = 0; }
+
+private:
+  void queued(size_t length) {
+    inFlight++;
+    messages++;
+    bytes += length;
+  }
+};
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+  AsyncWebSocket(const String &url) : wsUrl(url) {}
+  ~AsyncWebSocket() {
+    for (auto *c : clients)
+      delete c;
+  }
+
+  void onEvent(AwsEventHandler handler) { eventHandler = handler; }
+  size_t count() const {
+    size_t n = 0;
+    for (auto const *c : clients)
+      n += c->status() == WS_CONNECTED;
+    return n;
+  }
+  std::vector<AsyncWebSocketClient *> &getClients() { return clients; }
+  AsyncWebSocketClient *client(uint32_t id) {
+    for (auto *c : clients) {
+      if (c->id() == id)
+        return c;
+    }
+    return nullptr;
+  }
+
+  /** @brief Connects a new client and fires WS_EVT_CONNECT (bench only). */
+  AsyncWebSocketClient *connect() {
+    AsyncWebSocketClient *c = new AsyncWebSocketClient(++lastId);
+    clients.push_back(c);
+    if (eventHandler)
+      eventHandler(this, c, WS_EVT_CONNECT, nullptr, nullptr, 0);
+    return c;
+  }
+  /** @brief Removes a client and fires WS_EVT_DISCONNECT (bench only). */
+  void disconnect(AsyncWebSocketClient *c) {
+    c->clientStatus = WS_DISCONNECTED;
+    if (eventHandler)
+      eventHandler(this, c, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+    clients.erase(std::find(clients.begin(), clients.end(), c));
+    delete c;
+  }
+
+private:
+  String wsUrl;
+  std::vector<AsyncWebSocketClient *> clients;
+  AwsEventHandler eventHandler;
+  uint32_t lastId = 0;
+};
+
+#endif // BENCH_ESPASYNCWEBSERVER_H
@@ -0,0 +1,34 @@
+/**
+ * Host stand-in for the ESP8266 core's IPAddress (IPv4 only).
+ */
+
+#ifndef BENCH_IPADDRESS_H
+#define BENCH_IPADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+  IPAddress(uint32_t a) : addr(a) {}
+
+  operator uint32_t() const { return addr; }
+  bool fromString(const char *s) {
+    unsigned a, b, c, d;
+    if (s == nullptr || sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4)
+      return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  String toString() const {
+    char b[16];
+    snprintf(b, sizeof(b), "%u.%u.%u.%u", addr & 0xFF, addr >> 8 & 0xFF, addr >> 16 & 0xFF, addr >> 24);
+    return String(b);
+  }
+
+private:
+  uint32_t addr = 0;
+};
+
+#endif // BENCH_IPADDRESS_H
@@ -0,0 +1,233 @@
+/**
+ * Host stand-in for LittleFS: an in-memory file system with directories,
+ * enough for the configuration, asset index and run recorder code paths.
+ */
+
+#ifndef BENCH_LITTLEFS_H
+#define BENCH_LITTLEFS_H
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FSInfo {
+  size_t totalBytes;
+  size_t usedBytes;
+  size_t blockSize;
+  size_t pageSize;
+  size_t maxOpenFiles;
+  size_t maxPathLength;
+};
+
+struct MemFileData {
+  std::vector<uint8_t> bytes;
+  time_t lastWrite = 0;
+};
+
+class File : public Stream {
+public:
+  File() {}
+  File(std::shared_ptr<MemFileData> data, const String &path, bool writable) : data(data), path(path), writable(writable) {}
+
+  explicit operator bool() const { return data != nullptr; }
+  size_t size() const { return data ? data->bytes.size() : 0; }
+  size_t position() const { return pos; }
+  const char *name() const { return path.c_str(); }
+  time_t getLastWrite() const { return data ? data->lastWrite : 0; }
+  void close() { data.reset(); }
+
+  bool seek(uint32_t offset, SeekMode mode = SeekSet) {
+    if (!data)
+      return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : data->bytes.size();
+    if (base + offset > data->bytes.size())
+      return false;
+    pos = base + offset;
+    return true;
+  }
+  bool truncate(uint32_t length) {
+    if (!data || !writable)
+      return false;
+    data->bytes.resize(length);
+    pos = min(pos, (size_t)length);
+    return true;
+  }
+
+  int available() override { return data ? data->bytes.size() - pos : 0; }
+  int read() override { return available() > 0 ? data->bytes[pos++] : -1; }
+  int peek() override { return available() > 0 ? data->bytes[pos] : -1; }
+  size_t read(uint8_t *buf, size_t n) {
+    n = min(n, (size_t)available());
+    if (n > 0)
+      memcpy(buf, data->bytes.data() + pos, n);
+    pos += n;
+    return n;
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *buf, size_t n) override {
+    if (!data || !writable)
+      return 0;
+    if (pos + n > data->bytes.size())
+      data->bytes.resize(pos + n);
+    memcpy(data->bytes.data() + pos, buf, n);
+    pos += n;
+    return n;
+  }
+  using Print::write;
+
+private:
+  std::shared_ptr<MemFileData> data;
+  String path;
+  bool writable = false;
+  size_t pos = 0;
+};
+
+class FS;
+
+class Dir {
+public:
+  struct Entry {
+    String name;
+    bool directory;
+    String path;
+  };
+
+  Dir() {}
+  Dir(FS *fs, std::vector<Entry> entries) : fs(fs), entries(std::move(entries)) {}
+
+  bool next() { return ++index < (int)entries.size(); }
+  String fileName() const { return current().name; }
+  bool isDirectory() const { return current().directory; }
+  bool isFile() const { return !current().directory; }
+  size_t fileSize() const;
+  File openFile(const char *mode) const;
+
+private:
+  FS *fs = nullptr;
+  std::vector<Entry> entries;
+  int index = -1;
+  const Entry &current() const { return entries[index]; }
+};
+
+class LittleFSConfig {
+public:
+  void setAutoFormat(bool) {}
+};
+
+class FS {
+public:
+  size_t totalBytes = 1024 * 1024;
+
+  bool begin() { return true; }
+  void end() {}
+  bool format() {
+    files.clear();
+    dirs.clear();
+    return true;
+  }
+  void setConfig(const LittleFSConfig &) {}
+  bool info(FSInfo &info) {
+    size_t used = 0;
+    for (auto const &f : files)
+      used += (f.second->bytes.size() + 4095) / 4096 * 4096;
+    info = {totalBytes, used, 4096, 256, 5, 32};
+    return true;
+  }
+
+  File open(const String &path, const char *mode) {
+    String p = normalize(path);
+    auto it = files.find(p);
+    if (mode[0] == 'r') {
+      if (it == files.end() || dirs.count(p))
+        return File();
+      return File(it->second, p, mode[1] == '+');
+    }
+    std::shared_ptr<MemFileData> data = (it != files.end()) ? it->second : std::make_shared<MemFileData>();
+    if (mode[0] == 'w')
+      data->bytes.clear();
+    data->lastWrite = time(nullptr);
+    files[p] = data;
+    File f(data, p, true);
+    if (mode[0] == 'a')
+      f.seek(0, SeekEnd);
+    return f;
+  }
+  File open(const char *path, const char *mode) { return open(String(path), mode); }
+
+  bool exists(const String &path) {
+    String p = normalize(path);
+    return p == "/" || files.count(p) || dirs.count(p);
+  }
+  bool exists(const char *path) { return exists(String(path)); }
+  bool exists(const __FlashStringHelper *path) { return exists(String(path)); }
+  bool remove(const String &path) { return files.erase(normalize(path)) > 0; }
+  bool remove(const char *path) { return remove(String(path)); }
+  bool mkdir(const String &path) { return dirs.insert(normalize(path)).second; }
+  bool mkdir(const char *path) { return mkdir(String(path)); }
+  bool rename(const String &from, const String &to) {
+    auto it = files.find(normalize(from));
+    if (it == files.end())
+      return false;
+    files[normalize(to)] = it->second;
+    files.erase(it);
+    return true;
+  }
+  bool rename(const char *from, const char *to) { return rename(String(from), String(to)); }
+
+  Dir openDir(const String &path) {
+    String dir = normalize(path);
+    String prefix = dir == "/" ? dir : dir + "/";
+    std::set<String> seen;
+    std::vector<Dir::Entry> entries;
+    auto add = [&](const String &p, bool directory) {
+      if (!p.startsWith(prefix) || p == prefix)
+        return;
+      String rest = p.substring(prefix.length());
+      int slash = rest.indexOf('/');
+      if (slash >= 0) {
+        rest = rest.substring(0, slash);
+        directory = true;
+      }
+      if (seen.insert(rest).second)
+        entries.push_back({rest, directory, prefix + rest});
+    };
+    for (auto const &d : dirs)
+      add(d, true);
+    for (auto const &f : files)
+      add(f.first, false);
+    return Dir(this, std::move(entries));
+  }
+  Dir openDir(const char *path) { return openDir(String(path)); }
+
+  std::shared_ptr<MemFileData> data(const String &path) {
+    auto it = files.find(path);
+    return it == files.end() ? nullptr : it->second;
+  }
+
+private:
+  std::map<String, std::shared_ptr<MemFileData>> files;
+  std::set<String> dirs;
+
+  static String normalize(const String &path) {
+    String p = path.startsWith("/") ? path : "/" + path;
+    while (p.length() > 1 && p.endsWith("/"))
+      p.remove(p.length() - 1);
+    return p;
+  }
+};
+
+inline size_t Dir::fileSize() const {
+  auto d = fs->data(current().path);
+  return d ? d->bytes.size() : 0;
+}
+
+inline File Dir::openFile(const char *mode) const { return fs->open(current().path, mode); }
+
+extern FS LittleFS;
+
+#endif // BENCH_LITTLEFS_H
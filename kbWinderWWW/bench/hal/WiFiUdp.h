@@ -0,0 +1 @@
+/** Host stand-in for WiFiUdp (unused by the bench). */
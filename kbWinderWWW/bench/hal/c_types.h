@@ -0,0 +1,2 @@
+/** Host stand-in for the SDK's c_types.h (types come from Arduino.h). */
+#include <Arduino.h>
@@ -0,0 +1,26 @@
+/**
+ * Host stand-in for lwIP's interface list: one station interface.
+ */
+
+#ifndef BENCH_LWIP_NETIF_H
+#define BENCH_LWIP_NETIF_H
+
+#include <stdint.h>
+
+struct ip4_addr {
+  uint32_t addr;
+};
+
+struct netif {
+  netif *next;
+  ip4_addr ip_addr;
+  ip4_addr netmask;
+  ip4_addr gw;
+  char name[2];
+  uint8_t num;
+};
+
+extern netif *netif_list;
+extern netif *netif_default;
+
+#endif // BENCH_LWIP_NETIF_H
@@ -0,0 +1 @@
+/** Host stand-in for umm_malloc/umm_heap_select.h (a single heap). */
@@ -0,0 +1,5 @@
+/** Host stand-in for umm_malloc: heap statistics are printed by the bench. */
+#ifndef BENCH_UMM_MALLOC_H
+#define BENCH_UMM_MALLOC_H
+inline void *umm_info(void *, int) { return nullptr; }
+#endif
@@ -463,22 +463,63 @@ struct MainConfiguration {
     ui.resetToFactoryDefaults();
   }
 
+  static const uint8_t SECTION_COUNT = 4;
+
+  /** @brief Section names in JSON order ("system", "network", ...). */
+  static const char *sectionName(uint8_t index) {
+    static const char *const names[SECTION_COUNT] = {"system", "network", "security", "ui"};
+    return index < SECTION_COUNT ? names[index] : nullptr;
+  }
+
+  /**
+   * @brief Writes one section (by index) into root. Lets callers stream the
+   * configuration a section at a time.
+   */
+  void sectionToJson(uint8_t index, JsonObject root, bool isPublic = false, bool maskPasswords = false) const {
+    switch (index) {
+    case 0:
+      system.toJson(root, isPublic);
+      break;
+    case 1:
+      network.toJson(root, isPublic, maskPasswords);
+      break;
+    case 2:
+      security.toJson(root, isPublic, maskPasswords);
+      break;
+    case 3:
+      ui.toJson(root, isPublic);
+      break;
+    }
+  }
+
+  /**
+   * @brief Applies one section by name.
+   * @return false if there is no such section.
+   */
+  bool sectionFromJson(const char *name, JsonObjectConst src, bool isInternal = false) {
+    if (strcmp(name, "system") == 0)
+      system.fromJson(src, isInternal);
+    else if (strcmp(name, "network") == 0)
+      network.fromJson(src, isInternal);
+    else if (strcmp(name, "security") == 0)
+      security.fromJson(src, isInternal);
+    else if (strcmp(name, "ui") == 0)
+      ui.fromJson(src, isInternal);
+    else
+      return false;
+    return true;
+  }
+
   void toJson(JsonObject root, bool isPublic = false, bool maskPasswords = false) const {
-    system.toJson(root.createNestedObject("system"), isPublic);
-    network.toJson(root.createNestedObject("network"), isPublic, maskPasswords);
-    security.toJson(root.createNestedObject("security"), isPublic, maskPasswords);
-    ui.toJson(root.createNestedObject("ui"), isPublic);
+    for (uint8_t i = 0; i < SECTION_COUNT; i++)
+      sectionToJson(i, root.createNestedObject(sectionName(i)), isPublic, maskPasswords);
   }
 
   bool fromJson(JsonObjectConst src, bool isInternal = false) {
-    if (src["system"])
-      system.fromJson(src["system"], isInternal);
-    if (src["network"])
-      network.fromJson(src["network"], isInternal);
-    if (src["security"])
-      security.fromJson(src["security"], isInternal);
-    if (src["ui"])
-      ui.fromJson(src["ui"], isInternal);
+    for (uint8_t i = 0; i < SECTION_COUNT; i++) {
+      if (src[sectionName(i)])
+        sectionFromJson(sectionName(i), src[sectionName(i)], isInternal);
+    }
     logMessage(LOG_LEVEL_DEBUG, F("Config: Logic buffer updated.")); // TODO: validation
     return true;
   }
@@ -36,7 +36,13 @@ document.addEventListener("DOMContentLoaded", async () => {
   //checkIfUpdateAvailable();
 });
 
+let commandBatch = null; // collects sendCommand() calls while setAllSettings() runs
+
 function sendCommand(cmdText) {
+  if (commandBatch) {
+    commandBatch.push(cmdText);
+    return;
+  }
   console.log("Sending command:", cmdText);
   // encodeURIComponent dba o to, by znaki specjalne (spacje, #, &)
   // nie zepsuły struktury adresu URL
@@ -84,11 +90,22 @@ function setAllSettings(containerId) {
 
   const elements = container.querySelectorAll("input, select, textarea");
 
-  elements.forEach((el) => {
-    if (typeof el.onchange === "function") {
-      el.dispatchEvent(new Event("change", { bubbles: true }));
-    }
-  });
+  // One EEPROM write on the Nano for the whole burst instead of one per SET.
+  // Sent as a single newline-separated request so the ESP queues the lines
+  // in order; separate fetch() calls could let COMMIT overtake the SETs.
+  commandBatch = ["SET BEGIN"];
+  try {
+    elements.forEach((el) => {
+      if (typeof el.onchange === "function") {
+        el.dispatchEvent(new Event("change", { bubbles: true }));
+      }
+    });
+  } finally {
+    const batch = commandBatch;
+    commandBatch = null;
+    batch.push("SET COMMIT");
+    sendCommand(batch.join("\n"));
+  }
 }
 
 function generateDynamicUI() {
@@ -707,7 +724,13 @@ function initWebSocket() {
   // Tworzymy socket tylko, gdy jesteśmy na prawdziwym IP/hostnamie urządzenia
   socket = new WebSocket(`ws://${window.location.hostname}/ws`);
 
+  socket.binaryType = "arraybuffer";
+
   socket.onmessage = (event) => {
+    if (event.data instanceof ArrayBuffer) {
+      handleBinaryMessage(event.data);
+      return;
+    }
     try {
       const data = JSON.parse(event.data);
       handleWebsocketMessage(data);
@@ -726,6 +749,45 @@ function initWebSocket() {
   };
 }
 
+const WS_BIN_SAMPLES = 0x01;
+const LIVE_SAMPLES_MAX = 1500; // 30 s at 50 Hz
+let liveSamples = []; // { t, rpm, absPos, steps, layer }, newest last
+
+/**
+ * @brief Decodes a binary live-samples message (see telemetry.h on the ESP).
+ * The first sample is absolute, every next one a delta against the previous.
+ * @returns {Array<Object>} samples, rpm in RPM, t in ESP milliseconds.
+ */
+function decodeSamples(buffer) {
+  const view = new DataView(buffer);
+  const count = view.getUint8(1);
+  let t = view.getUint32(2, true);
+  let rpm = view.getInt32(6, true);
+  let absPos = view.getInt32(10, true);
+  let steps = view.getInt32(14, true);
+  let layer = view.getUint16(18, true);
+  const samples = [{ t, rpm: rpm / 256, absPos, steps, layer }];
+
+  let offset = 20;
+  for (let i = 1; i < count && offset + 8 <= buffer.byteLength; i++, offset += 8) {
+    t += view.getUint8(offset);
+    rpm += view.getInt16(offset + 1, true);
+    absPos += view.getInt16(offset + 3, true);
+    steps += view.getInt16(offset + 5, true);
+    layer += view.getInt8(offset + 7);
+    samples.push({ t, rpm: rpm / 256, absPos, steps, layer });
+  }
+  return samples;
+}
+
+function handleBinaryMessage(buffer) {
+  lastWsMessageTime = Date.now();
+  if (buffer.byteLength < 20 || new DataView(buffer).getUint8(0) !== WS_BIN_SAMPLES) return;
+
+  liveSamples.push(...decodeSamples(buffer));
+  if (liveSamples.length > LIVE_SAMPLES_MAX) liveSamples.splice(0, liveSamples.length - LIVE_SAMPLES_MAX);
+}
+
 function handleWebsocketMessage(data) {
   lastWsMessageTime = Date.now();
 
@@ -32,6 +32,8 @@ VarMap varTable[] = { { "SCREW PITCH", &cfg.screwPitch, T_FLOAT, C_MACHINE, 0 },
                       { "TRAVERSE START SPEED", &cfg.startRPM_T, T_INT, C_MACHINE, 0 },
                       { "WINDER DEFAULT RAMP", &cfg.defaultRamp_W, T_INT, C_MACHINE, 0 },
                       { "TRAVERSE DEFAULT RAMP", &cfg.defaultRamp_T, T_INT, C_MACHINE, 0 },          
+                      { "WINDER JERK", &cfg.jerk_W, T_INT, C_MACHINE, 0 },
+                      { "TRAVERSE JERK", &cfg.jerk_T, T_INT, C_MACHINE, 0 },
                       { "WINDER DIRECTION", &cfg.dirW, T_BOOL, C_MACHINE, 0 },
                       { "TRAVERSE DIRECTION", &cfg.dirT, T_BOOL, C_MACHINE, 0 },
                       { "LIMIT SWITCH", &cfg.useLimitSwitch, T_BOOL, C_MACHINE, 0 },
@@ -55,8 +57,7 @@ VarMap varTable[] = { { "SCREW PITCH", &cfg.screwPitch, T_FLOAT, C_MACHINE, 0 },
                       { "IS HOMED", &isHomed, T_BOOL, C_RUNTIME, 0 },
                       { "HOMING PHASE", &homingPhase, T_INT, C_RUNTIME, 0 },
 
-                      { "LAST STEP MICROS", &lastStepMicros, T_LONG, C_RUNTIME, 0 },
-                      { "TRAVERSE ACCUMULATOR", &traverseAccumulator, T_FLOAT, C_RUNTIME, 0 },
+                      { "TRAVERSE ACCUMULATOR", &traverseAccumulator, T_LONG, C_RUNTIME, 0 },
                       { "CURRENT LAYER STEPS", &currentLayerSteps, T_LONG, C_RUNTIME, 0 },
                       { "LAYER DIRECTION", &layerDir, T_INT, C_RUNTIME, 0 },
                       { "BACKOFF DISTANCE MM", &backoffDistanceMM, T_FLOAT, C_RUNTIME, 0 } };
@@ -119,6 +119,7 @@ void initializeSerial(bool firstTime = false);
  * @brief Global logging function with multiple overloads.
  */
 void logMessage(LogLevel level, const String &message);
+void logMessage(LogLevel level, const char *message);
 void logMessage(LogLevel level, const __FlashStringHelper *message);
 
 /**
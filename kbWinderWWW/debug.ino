@@ -72,7 +72,7 @@ void sayHello() {
 
 void debugSerialFlush() { DEBUG_UART.flush(); }
 
-void serialPrintLog(LogLevel level, String message, bool newLine = true) {
+void serialPrintLog(LogLevel level, const char *message, bool newLine = true) {
   if (!serialInitialized)
     return;
 
@@ -95,9 +95,9 @@ void serialPrintLog(LogLevel level, String message, bool newLine = true) {
 
   // Wariant B: Kolorujemy cały wiersz (lepiej widoczne w KiTTY)
   if (newLine) {
-    DEBUG_UART.printf("\r%s[%-7S] %s%s\n", color, levelName, message.c_str(), reset);
+    DEBUG_UART.printf("\r%s[%-7S] %s%s\n", color, levelName, message, reset);
   } else {
-    DEBUG_UART.printf("\r%s[%-7S] %s%s", color, levelName, message.c_str(), reset);
+    DEBUG_UART.printf("\r%s[%-7S] %s%s", color, levelName, message, reset);
   }
 }
 
@@ -106,7 +106,7 @@ void serialPrintLog(LogLevel level, String message, bool newLine = true) {
  * @param level Severity level.
  * @param message The message string.
  */
-void processLog(LogLevel level, String message, bool newLine = true) {
+void processLog(LogLevel level, const char *message, bool newLine = true) {
   if (level == LOG_LEVEL_NOTHING)
     return;
 
@@ -130,12 +130,17 @@ void processLog(LogLevel level, String message, bool newLine = true) {
 /**
  * @brief Overload for standard Strings.
  */
-void logMessage(LogLevel level, const String &message) { processLog(level, message); }
+void logMessage(LogLevel level, const String &message) { processLog(level, message.c_str()); }
+
+/**
+ * @brief Overload for plain C strings, logged without copying.
+ */
+void logMessage(LogLevel level, const char *message) { processLog(level, message); }
 
 /**
  * @brief Overload for Flash Strings (F() macro) - Fixes the "ambiguous" error.
  */
-void logMessage(LogLevel level, const __FlashStringHelper *message) { processLog(level, String(message)); }
+void logMessage(LogLevel level, const __FlashStringHelper *message) { processLog(level, String(message).c_str()); }
 
 void logMessagef(LogLevel level, const char *format, ...) {
   char buffer[MAX_LOG_LINE_LENGTH];
@@ -144,7 +149,7 @@ void logMessagef(LogLevel level, const char *format, ...) {
   vsnprintf_P(buffer, sizeof(buffer), format, args);
   va_end(args);
 
-  processLog(level, String(buffer));
+  processLog(level, buffer);
 }
 
 void logMessageEmptyLine(uint8 count) {
@@ -0,0 +1,81 @@
+/**
+ * @file jsonstream.h
+ * @brief Chunked JSON responses and streaming JSON request bodies.
+ *
+ * Large JSON answers (/api/configuration, /api/list-files) are produced a
+ * piece at a time from the chunk callback: each piece (one configuration
+ * section, one file entry) is serialized into a fixed buffer and copied out
+ * as the TCP stack asks for more. No full document or String is ever built.
+ *
+ * POST /api/configuration is scanned as it arrives. Only the section being
+ * received ("values.network", ...) is kept, and it is parsed and applied to
+ * a staged copy of the configuration as soon as its closing brace arrives.
+ * The staged copy becomes the live one when the whole body was valid.
+ */
+
+#ifndef JSONSTREAM_H
+#define JSONSTREAM_H
+
+#include "configuration.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include <new>
+
+#define JSON_PIECE_SIZE 1024       ///< Largest single piece (one config section)
+#define JSON_SECTION_DOC_SIZE 1024 ///< Document for one section
+#define LIST_FILES_MAX_DEPTH 6     ///< Deeper directories are skipped
+#define CONFIG_KEY_LEN 16
+
+/**
+ * @brief Source of a chunked JSON response. nextPiece() fills "piece" with
+ * the next part of the document and returns false after the last one.
+ */
+struct JsonChunkSource {
+  char piece[JSON_PIECE_SIZE];
+  size_t pieceLength = 0;
+  size_t piecePos = 0;
+  bool first = true; ///< No comma before the first member / element
+
+  virtual ~JsonChunkSource() {}
+  virtual bool nextPiece() = 0;
+
+  bool setPiece(const char *text);
+  bool setMembers(const JsonDocument &doc);
+  bool setElement(const JsonDocument &doc);
+};
+
+/**
+ * @brief State of the POST /api/configuration body scanner.
+ */
+struct ConfigBodyParser {
+  MainConfiguration staged;
+
+  uint8_t depth = 0;
+  bool inString = false;
+  bool escaped = false;
+  bool expectKey = false;
+
+  char key[CONFIG_KEY_LEN]; ///< Last key at depth 1 or 2
+  uint8_t keyLength = 0;
+  bool keyTruncated = false; ///< Key longer than key[], matches nothing
+  bool inValues = false;   ///< Inside the top-level "values" object
+  bool sawValues = false;
+  char section[CONFIG_KEY_LEN];
+  bool capturing = false;  ///< Copying a section into "buffer"
+
+  char buffer[JSON_PIECE_SIZE];
+  size_t length = 0;
+  uint8_t sectionsApplied = 0;
+  const char *error = nullptr;
+};
+
+ConfigBodyParser *configBodyParser = nullptr;
+
+void sendChunkedJson(AsyncWebServerRequest *request, std::shared_ptr<JsonChunkSource> source);
+void beginConfigBody();
+void feedConfigBody(const uint8_t *data, size_t len);
+const char *finishConfigBody();
+
+#endif
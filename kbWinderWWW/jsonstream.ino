@@ -0,0 +1,220 @@
+/**
+ * @file jsonstream.ino
+ * @brief Chunked JSON writer and the streaming configuration body parser.
+ */
+
+#include "jsonstream.h"
+
+// --- Chunked responses ---
+
+bool JsonChunkSource::setPiece(const char *text) {
+  pieceLength = strlcpy(piece, text, sizeof(piece));
+  piecePos = 0;
+  return true;
+}
+
+/**
+ * @brief Puts the members of an object document into the piece, without
+ * its braces, so pieces can be joined into one object.
+ * An empty or oversized document gives an empty piece.
+ */
+bool JsonChunkSource::setMembers(const JsonDocument &doc) {
+  piecePos = pieceLength = 0;
+  if (measureJson(doc) + 2 > sizeof(piece)) {
+    logMessage(LOG_LEVEL_ERROR, F("JSON: Piece too large, skipped"));
+    return true;
+  }
+  // piece = ",{...}" -> wysyłamy ",..." albo "..." (bez klamer)
+  size_t n = serializeJson(doc, piece + 1, sizeof(piece) - 1);
+  if (n <= 2)
+    return true;
+  piece[1] = ',';
+  piecePos = first ? 2 : 1;
+  pieceLength = n;
+  first = false;
+  return true;
+}
+
+/**
+ * @brief Puts one array element into the piece, with a comma if needed.
+ */
+bool JsonChunkSource::setElement(const JsonDocument &doc) {
+  piecePos = pieceLength = 0;
+  if (measureJson(doc) + 2 > sizeof(piece)) {
+    logMessage(LOG_LEVEL_ERROR, F("JSON: Piece too large, skipped"));
+    return true;
+  }
+  piece[0] = ',';
+  pieceLength = serializeJson(doc, piece + 1, sizeof(piece) - 1) + 1;
+  piecePos = first ? 1 : 0;
+  first = false;
+  return true;
+}
+
+/**
+ * @brief Sends a JSON document produced piece by piece (chunked encoding).
+ */
+void sendChunkedJson(AsyncWebServerRequest *request, std::shared_ptr<JsonChunkSource> source) {
+  request->send(request->beginChunkedResponse(FPSTR(APPLICATION_JSON), [source](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+    size_t written = 0;
+    while (written < maxLen) {
+      if (source->piecePos >= source->pieceLength && !source->nextPiece())
+        break;
+      size_t n = min(source->pieceLength - source->piecePos, maxLen - written);
+      memcpy(buffer + written, source->piece + source->piecePos, n);
+      source->piecePos += n;
+      written += n;
+    }
+    return written; // 0 = koniec
+  }));
+}
+
+// --- Streaming configuration body ---
+
+static bool isConfigSection(const char *name) {
+  for (uint8_t i = 0; i < MainConfiguration::SECTION_COUNT; i++) {
+    if (strcmp(name, MainConfiguration::sectionName(i)) == 0)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Parses the captured section and applies it to the staged copy.
+ */
+static void applyConfigSection(ConfigBodyParser &p) {
+  p.buffer[p.length] = 0;
+  logMessagef(LOG_LEVEL_VERBOSE, "API: Section %s: %s", p.section, p.buffer);
+
+  DynamicJsonDocument doc(JSON_SECTION_DOC_SIZE);
+  DeserializationError error = deserializeJson(doc, p.buffer, p.length); // zero-copy, bufor jest nasz
+  if (error || !doc.is<JsonObject>()) {
+    logMessagef(LOG_LEVEL_ERROR, "API: Section %s: %s", p.section, error ? error.c_str() : "not an object");
+    p.error = "Invalid JSON";
+    return;
+  }
+  p.staged.sectionFromJson(p.section, doc.as<JsonObjectConst>());
+  p.sectionsApplied++;
+}
+
+void beginConfigBody() {
+  delete configBodyParser;
+  configBodyParser = new (std::nothrow) ConfigBodyParser();
+  if (configBodyParser != nullptr)
+    configBodyParser->staged = configuration;
+}
+
+/**
+ * @brief Scans the next part of the body. Tracks nesting and strings only;
+ * the members of "values" that are configuration sections are copied out
+ * and applied one at a time, everything else is skipped.
+ */
+void feedConfigBody(const uint8_t *data, size_t len) {
+  if (configBodyParser == nullptr || configBodyParser->error != nullptr)
+    return;
+  ConfigBodyParser &p = *configBodyParser;
+
+  for (size_t i = 0; i < len && p.error == nullptr; i++) {
+    char c = (char)data[i];
+
+    if (p.capturing) {
+      if (p.length >= sizeof(p.buffer) - 1) {
+        logMessagef(LOG_LEVEL_ERROR, "API: Section %s exceeds %d bytes", p.section, JSON_PIECE_SIZE);
+        p.error = "Section too large";
+        return;
+      }
+      p.buffer[p.length++] = c;
+    }
+
+    if (p.inString) {
+      bool collecting = p.expectKey && !p.capturing;
+      if (p.escaped) {
+        p.escaped = false;
+      } else if (c == '\\') {
+        p.escaped = true;
+        continue;
+      } else if (c == '"') {
+        p.inString = false;
+        // Przycięty klucz mógłby udawać "values" lub nazwę sekcji
+        p.key[p.keyTruncated ? 0 : p.keyLength] = 0;
+        continue;
+      }
+      if (collecting && p.keyLength < sizeof(p.key) - 1)
+        p.key[p.keyLength++] = c;
+      else if (collecting)
+        p.keyTruncated = true;
+      continue;
+    }
+
+    switch (c) {
+    case '"':
+      p.inString = true;
+      p.keyLength = 0;
+      p.keyTruncated = false;
+      break;
+    case '{':
+    case '[':
+      if (++p.depth > 32) {
+        p.error = "Invalid JSON";
+        break;
+      }
+      if (c == '{' && p.depth == 2 && p.expectKey == false && strcmp(p.key, "values") == 0) {
+        p.inValues = p.sawValues = true;
+      } else if (c == '{' && p.depth == 3 && p.inValues && isConfigSection(p.key)) {
+        strlcpy(p.section, p.key, sizeof(p.section));
+        p.capturing = true;
+        p.buffer[0] = '{';
+        p.length = 1;
+      }
+      p.expectKey = (c == '{' && p.depth <= 2);
+      p.key[0] = 0;
+      break;
+    case '}':
+    case ']':
+      if (p.depth == 0) {
+        p.error = "Invalid JSON";
+        break;
+      }
+      p.depth--;
+      if (p.capturing && p.depth == 2) {
+        p.capturing = false;
+        applyConfigSection(p);
+      } else if (p.inValues && p.depth == 1) {
+        p.inValues = false;
+      }
+      p.expectKey = false;
+      break;
+    case ':':
+      p.expectKey = false;
+      break;
+    case ',':
+      // Klucze śledzimy tylko na poziomie głównym i w "values" (obiekty)
+      p.expectKey = (p.depth == 1 || (p.depth == 2 && p.inValues));
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Ends the body; on success the staged configuration becomes live.
+ * @return nullptr on success, otherwise the error message for the client.
+ */
+const char *finishConfigBody() {
+  if (configBodyParser == nullptr)
+    return "Out of memory";
+  ConfigBodyParser &p = *configBodyParser;
+
+  const char *error = p.error;
+  if (error == nullptr && (p.depth != 0 || p.inString))
+    error = "Invalid JSON";
+  if (error == nullptr && !p.sawValues)
+    error = "Missing 'values' object";
+
+  if (error == nullptr) {
+    configuration = p.staged;
+    logMessagef(LOG_LEVEL_DEBUG, "Config: Logic buffer updated (%d sections).", p.sectionsApplied);
+  }
+  delete configBodyParser;
+  configBodyParser = nullptr;
+  return error;
+}
@@ -38,8 +38,37 @@ bool updateWsStatusPending = false;
 #include <deque>
 
 std::deque<String> commandQueue;
-unsigned long lastCommandSentTime = 0;
-const unsigned long COMMAND_SPACING_MS = 50; // Przerwa między komendami dla Nano
+
+/**
+ * @name Nano flow control
+ * Queued commands go out as "#<seq> <command>" and the Nano answers
+ * "ACK <seq>" once it has run them. Unacked bytes may not exceed the Nano's
+ * RX buffer, so batches go out at link speed without overrunning it.
+ */
+///@{
+struct InFlightCommand {
+  uint8_t seq;
+  uint8_t length;       // bytes on the wire, tag and newline included
+  unsigned long sentAt;
+};
+
+std::deque<InFlightCommand> commandsInFlight;
+uint16_t bytesInFlight = 0;
+uint8_t commandSeq = 0;
+const uint16_t NANO_RX_WINDOW = 60;            // Nano RX buffer is 64 bytes
+const unsigned long COMMAND_ACK_TIMEOUT_MS = 1000; // Nano reset or ack lost
+///@}
+
+/**
+ * @name Nano console
+ * Nano output is split into lines as it arrives, in a fixed buffer.
+ * Longer lines are forwarded in pieces and counted in nanoLineOverflows.
+ */
+///@{
+#define NANO_LINE_BUFFER_SIZE 128
+const unsigned long NANO_LINE_FLUSH_MS = 50; // unterminated text (prompt)
+uint32_t nanoLineOverflows = 0;
+///@}
 
 
 #endif // KBWINDER_H
\ No newline at end of file
@@ -23,10 +23,15 @@ const char S_PRODURL[] PROGMEM = "https://kamilbaranski.com/kbWinderWWW/"; ///<
 
 #include "configuration.h"
 #include "debug.h"
+#include "jsonstream.h"
 #include "kbWinderWWW.h"
 #include "network.h"
 #include "reset.h"
+#include "runrecorder.h"
+#include "telemetry.h"
 #include "webserver.h"
+#include "websockets.h"
+#include "winderstate.h"
 
 /** @brief Global configuration instance holding system, network, and logic settings */
 MainConfiguration configuration;
@@ -73,6 +78,7 @@ void setup() {
   logMessage(LOG_LEVEL_NOTICE, F("SYSTEM: Booting kbWinder..."));
 
   initializeFileSystem(); ///< Mount LittleFS
+  initializeRunRecorder(); ///< Find the last run, prune old ones
   setupConfiguration();   ///< Load configuration.json from Flash
 
   initializeNetwork();   ///< Start WiFi (AP/STA)
@@ -101,6 +107,9 @@ void loop() {
 
   processCommandQueue();
   handleUpdateWsStatusPending();
+  processTelemetrySamples();
+  processRunRecorder();
+  processWsOutboxes();
 
   processPendingReboot(); ///< Execute reboot if requested by Web UI
   processFlashButton();   ///< Monitor button for long-press resets
@@ -108,49 +117,58 @@ void loop() {
 
 #define NanoUart Serial
 
+/**
+ * @brief Forwards one line of Nano output, trimmed in place (no copies).
+ * "ACK <seq>" returns credits to the command queue and is not logged,
+ * everything else also updates the winderState cache.
+ */
+void forwardNanoLine(char *line, uint8_t length) {
+  while (length > 0 && isspace(line[length - 1]))
+    length--;
+  line[length] = 0;
+  while (isspace(*line))
+    line++;
+  if (*line == 0)
+    return;
+
+  if (strncmp(line, "ACK ", 4) == 0) {
+    handleNanoAck(atoi(line + 4));
+    return;
+  }
+  parseNanoLine(line);
+  logMessage(LOG_LEVEL_NANO, line);
+}
+
 void processSerialInput() {
-  static String batchBuffer = "";
+  static char line[NANO_LINE_BUFFER_SIZE];
+  static uint8_t lineLength = 0;
   static unsigned long lastCharTime = 0;
-  const unsigned long timeout = 50; // Czekamy 50ms na koniec paczki danych
 
-  // 1. Czytamy wszystko co jest w buforze sprzętowym do batchBuffer
+  // Każda pełna linia idzie dalej od razu, bez czekania na ciszę na UART.
+  // Binary telemetry frames (TELEMETRY ON) are decoded on the fly, the rest is console text
   while (DEBUG_UART.available()) {
     char c = DEBUG_UART.read();
-    batchBuffer += c;
+    if (telemetryFeed((uint8_t)c))
+      continue;
     lastCharTime = millis();
-  }
-
-  // 2. Jeśli mamy coś w buforze i DEBUG_UART milczy od 50ms (koniec serii danych)
-  if (batchBuffer.length() > 0 && (millis() - lastCharTime > timeout)) {
 
-    // Logujemy to lokalnie (opcjonalnie)
-    logMessage(LOG_LEVEL_DEBUG, "Batch received, size: " + String(batchBuffer.length()));
-
-    int startIdx = 0;
-    int endIdx = batchBuffer.indexOf('\n');
-
-    // Pętla rozbijająca String na linie
-    while (endIdx != -1) {
-      String line = batchBuffer.substring(startIdx, endIdx);
-      line.trim(); // Usuwamy śmieci typu \r
-
-      if (line.length() > 0) {
-        // Wysyłamy każdą linię osobno - JS dostanie to co lubi
-        logMessage(LOG_LEVEL_NANO, line);
-      }
-
-      startIdx = endIdx + 1;
-      endIdx = batchBuffer.indexOf('\n', startIdx);
+    if (c == '\n') {
+      forwardNanoLine(line, lineLength);
+      lineLength = 0;
+      continue;
     }
-
-    // Jeśli coś zostało na końcu bez znaku nowej linii (rzadkie, ale możliwe)
-    String remaining = batchBuffer.substring(startIdx);
-    remaining.trim();
-    if (remaining.length() > 0) {
-      logMessage(LOG_LEVEL_NANO, remaining);
+    if (lineLength == NANO_LINE_BUFFER_SIZE - 1) {
+      // Za długa linia - wysyłamy ją w kawałkach
+      nanoLineOverflows++;
+      forwardNanoLine(line, lineLength);
+      lineLength = 0;
     }
+    line[lineLength++] = c;
+  }
 
-    // Czyścimy bufor pod następną serię
-    batchBuffer = "";
+  // Tekst bez znaku nowej linii (np. prompt) wysyłamy, gdy Nano zamilknie
+  if (lineLength > 0 && millis() - lastCharTime > NANO_LINE_FLUSH_MS) {
+    forwardNanoLine(line, lineLength);
+    lineLength = 0;
   }
 }
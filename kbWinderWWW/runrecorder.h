@@ -0,0 +1,102 @@
+/**
+ * @file runrecorder.h
+ * @brief Records every winding run to LittleFS (/runs/run<N>_<chunk>.bin).
+ *
+ * A run starts with "Winding sequence enqueued." and ends when the Nano
+ * reports IDLE again. While it lasts, a sample (turns, RPM, position, layer)
+ * is taken every RUN_SAMPLE_MS and every pause, layer flip, alarm and task
+ * end is added as an event. Records collect in RAM and go to flash in
+ * batches.
+ *
+ * Files are only ever appended to: LittleFS is copy-on-write, so a write in
+ * the middle of a file (or to a header at its start) copies every block
+ * after it. A run is split into chunk files of RUN_CHUNK_RECORDS records;
+ * starting a new chunk deletes the one RUN_CHUNKS back, so a very long run
+ * keeps its newest part and never takes more than RUN_CHUNKS chunks. The
+ * record count of a chunk is its size, nothing is rewritten.
+ *
+ * /api/runs lists the runs, /api/runs?id=N streams one out as CSV.
+ */
+
+#ifndef RUNRECORDER_H
+#define RUNRECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define RUN_DIR "/runs"
+#define RUNS_MAX 5              ///< Older runs are deleted
+#define RUN_CHUNK_RECORDS 1024  ///< Records per chunk file, ~17 min of samples
+#define RUN_CHUNKS 2            ///< Newest chunks kept per run
+#define RUN_SAMPLE_MS 1000
+#define RUN_FLUSH_RECORDS 32    ///< Records per flash write
+#define RUN_FILE_MAGIC 0x4E52424B // "KBRN"
+
+enum RunRecordType : uint8_t { RUN_REC_SAMPLE = 0, RUN_REC_EVENT = 1 };
+
+enum RunEvent : uint8_t {
+  RUN_EV_START = 1,
+  RUN_EV_END,
+  RUN_EV_PAUSE,
+  RUN_EV_RESUME,
+  RUN_EV_LAYER_FLIP,
+  RUN_EV_TASK_DONE,
+  RUN_EV_ALARM,
+};
+
+/// Written once when a chunk is created, followed by its records
+struct __attribute__((packed)) RunFileHeader {
+  uint32_t magic;
+  uint16_t recordSize;
+  uint16_t chunk;     ///< 0 for the first chunk of a run
+  uint32_t startTime; ///< Unix time if the clock was set, else 0
+};
+
+struct __attribute__((packed)) RunRecord {
+  uint32_t t;      ///< ms since the start of the run
+  uint8_t type;    ///< RunRecordType
+  uint8_t code;    ///< RunEvent, 0 for samples
+  uint16_t layer;
+  uint16_t rpmX10;
+  uint16_t reserved;
+  int32_t turnsX10;
+  int32_t absPosUm; ///< Traverse position in micrometres
+};
+
+struct RunRecorder {
+  bool active = false;
+  uint32_t runId = 0;
+  uint16_t chunk = 0;         ///< Chunk being appended to
+  uint16_t chunkRecords = 0;  ///< Records already in it
+  uint32_t startTime = 0;
+  File file;                  ///< Open for appending while the run lasts
+  unsigned long startedAt = 0;
+  unsigned long lastSample = 0;
+  RunRecord pending[RUN_FLUSH_RECORDS];
+  uint8_t pendingCount = 0;
+};
+
+RunRecorder runRecorder;
+
+/**
+ * @brief State of one CSV download, shared by the chunk callbacks.
+ * The chunk files of the run are read front to back, one after another.
+ */
+struct RunCsvStream {
+  uint32_t id = 0;
+  uint16_t chunk = 0;     ///< Chunk being read
+  uint16_t lastChunk = 0;
+  File file;
+  bool headerSent = false;
+  char line[96];
+  uint8_t lineLength = 0;
+  uint8_t linePos = 0;
+};
+
+void initializeRunRecorder();
+void runRecorderStart();
+void runRecorderStop();
+void runRecorderEvent(RunEvent code);
+void processRunRecorder();
+
+#endif
@@ -0,0 +1,386 @@
+/**
+ * @file runrecorder.ino
+ * @brief Run recorder: sampling, append-only chunk files and CSV export.
+ */
+
+#include "runrecorder.h"
+
+#include <memory>
+
+static String runFileName(uint32_t id, uint16_t chunk) {
+  return String(RUN_DIR) + "/run" + String(id) + "_" + String(chunk) + ".bin";
+}
+
+/**
+ * @brief Splits "run<id>_<chunk>.bin" into its numbers; false for other files.
+ */
+static bool parseRunFileName(const String &name, uint32_t &id, uint16_t &chunk) {
+  int sep = name.indexOf('_');
+  if (!name.startsWith("run") || !name.endsWith(".bin") || sep < 4)
+    return false;
+  id = name.substring(3, sep).toInt();
+  chunk = name.substring(sep + 1).toInt();
+  return true;
+}
+
+/**
+ * @brief Finds the first and last chunk of a run; false if it has none.
+ */
+static bool findRunChunks(uint32_t id, uint16_t &first, uint16_t &last) {
+  bool found = false;
+  Dir dir = LittleFS.openDir(RUN_DIR);
+  while (dir.next()) {
+    uint32_t fileId;
+    uint16_t chunk;
+    if (!parseRunFileName(dir.fileName(), fileId, chunk) || fileId != id)
+      continue;
+    first = found ? min(first, chunk) : chunk;
+    last = found ? max(last, chunk) : chunk;
+    found = true;
+  }
+  return found;
+}
+
+static void removeRun(uint32_t id) {
+  uint16_t first, last;
+  if (!findRunChunks(id, first, last))
+    return;
+  for (uint16_t chunk = first; chunk <= last; chunk++)
+    LittleFS.remove(runFileName(id, chunk));
+}
+
+/**
+ * @brief Finds the newest run id and removes runs beyond RUNS_MAX.
+ * @param keep Number of runs to keep (RUNS_MAX - 1 right before a new one).
+ */
+static uint32_t pruneRuns(uint8_t keep) {
+  uint32_t ids[RUNS_MAX * 2];
+  uint8_t count = 0;
+  uint32_t newest = 0;
+
+  Dir dir = LittleFS.openDir(RUN_DIR);
+  while (dir.next()) {
+    uint32_t id;
+    uint16_t chunk;
+    if (!parseRunFileName(dir.fileName(), id, chunk))
+      continue;
+    newest = max(newest, id);
+    bool known = false;
+    for (uint8_t i = 0; i < count && !known; i++)
+      known = ids[i] == id;
+    if (!known && count < RUNS_MAX * 2)
+      ids[count++] = id;
+  }
+
+  // Usuwamy najstarsze, aż zostanie "keep" przebiegów
+  while (count > keep) {
+    uint8_t oldest = 0;
+    for (uint8_t i = 1; i < count; i++) {
+      if (ids[i] < ids[oldest])
+        oldest = i;
+    }
+    removeRun(ids[oldest]);
+    ids[oldest] = ids[--count];
+  }
+  return newest;
+}
+
+void initializeRunRecorder() {
+  if (!fileSystemInitialized)
+    return;
+  if (!LittleFS.exists(RUN_DIR))
+    LittleFS.mkdir(RUN_DIR);
+  runRecorder.runId = pruneRuns(RUNS_MAX);
+}
+
+/**
+ * @brief Creates the current chunk file and drops the one RUN_CHUNKS back.
+ */
+static bool openRunChunk() {
+  RunRecorder &r = runRecorder;
+  r.file = LittleFS.open(runFileName(r.runId, r.chunk), "a");
+  if (!r.file) {
+    logMessage(LOG_LEVEL_ERROR, F("RUN: Cannot create run file"));
+    return false;
+  }
+  RunFileHeader header = {RUN_FILE_MAGIC, sizeof(RunRecord), r.chunk, r.startTime};
+  r.file.write((const uint8_t *)&header, sizeof(header));
+  r.chunkRecords = 0;
+  if (r.chunk >= RUN_CHUNKS)
+    LittleFS.remove(runFileName(r.runId, r.chunk - RUN_CHUNKS));
+  return true;
+}
+
+/**
+ * @brief Appends the pending records, moving on to a new chunk when full.
+ */
+static void flushRunRecords() {
+  RunRecorder &r = runRecorder;
+  if (r.pendingCount == 0)
+    return;
+  if (!r.file) {
+    logMessage(LOG_LEVEL_ERROR, F("RUN: Run file not open, records lost"));
+    r.pendingCount = 0;
+    return;
+  }
+
+  uint8_t done = 0;
+  while (done < r.pendingCount) {
+    if (r.chunkRecords == RUN_CHUNK_RECORDS) {
+      r.file.close();
+      r.chunk++;
+      if (!openRunChunk()) {
+        r.pendingCount = 0;
+        return;
+      }
+    }
+    uint8_t n = min((uint16_t)(r.pendingCount - done), (uint16_t)(RUN_CHUNK_RECORDS - r.chunkRecords));
+    r.file.write((const uint8_t *)&r.pending[done], n * sizeof(RunRecord));
+    r.chunkRecords += n;
+    done += n;
+  }
+  r.file.flush();
+  r.pendingCount = 0;
+}
+
+/**
+ * @brief Value of a setting from the last GET dump, or fallback.
+ */
+static float winderSetting(const char *label, float fallback) {
+  auto it = winderState.settings.find(label);
+  return (it != winderState.settings.end()) ? it->second.toFloat() : fallback;
+}
+
+/**
+ * @brief Adds a record with the current machine state.
+ * Binary telemetry is used while it is fresh, the console state otherwise.
+ */
+static void addRunRecord(RunRecordType type, uint8_t code) {
+  RunRecorder &r = runRecorder;
+  const NanoTelemetry &t = nanoTelemetry;
+  const WinderState &w = winderState;
+
+  RunRecord rec = {};
+  rec.t = millis() - r.startedAt;
+  rec.type = type;
+  rec.code = code;
+
+  float turns = w.turns;
+  float absPosMM = w.absPosMM;
+  float rpm = w.rpm;
+  rec.layer = w.layerFlips;
+  if (t.valid && millis() - t.receivedAt <= TLM_STALE_MS) {
+    rpm = t.rpm;
+    rec.layer = t.layer;
+    float stepsPerRevW = winderSetting("WINDER STEPS PER REV", 0);
+    float stepsPerRevT = winderSetting("TRAVERSE STEPS PER REV", 0);
+    if (stepsPerRevW > 0 && t.motor != 'T')
+      turns = t.currentSteps / stepsPerRevW;
+    if (stepsPerRevT > 0)
+      absPosMM = t.absPos * winderSetting("SCREW PITCH", 1) / stepsPerRevT;
+  }
+  rec.rpmX10 = (uint16_t)constrain(rpm * 10, 0, 65535);
+  rec.turnsX10 = (int32_t)(turns * 10);
+  rec.absPosUm = (int32_t)(absPosMM * 1000);
+
+  r.pending[r.pendingCount++] = rec;
+  if (r.pendingCount == RUN_FLUSH_RECORDS)
+    flushRunRecords();
+}
+
+/**
+ * @brief Starts a new run: its first chunk holds only the header so far.
+ */
+void runRecorderStart() {
+  RunRecorder &r = runRecorder;
+  if (!fileSystemInitialized)
+    return;
+  if (r.active)
+    runRecorderStop();
+
+  r.runId = pruneRuns(RUNS_MAX - 1) + 1;
+  r.chunk = 0;
+  time_t now = time(nullptr);
+  r.startTime = (uint32_t)(now > 1000000000 ? now : 0);
+  if (!openRunChunk())
+    return;
+
+  r.active = true;
+  r.startedAt = millis();
+  r.lastSample = r.startedAt;
+  r.pendingCount = 0;
+  addRunRecord(RUN_REC_EVENT, RUN_EV_START);
+  logMessagef(LOG_LEVEL_INFO, "RUN: Recording run %u", r.runId);
+}
+
+void runRecorderStop() {
+  RunRecorder &r = runRecorder;
+  if (!r.active)
+    return;
+  addRunRecord(RUN_REC_EVENT, RUN_EV_END);
+  flushRunRecords();
+  r.file.close();
+  r.active = false;
+  logMessagef(LOG_LEVEL_INFO, "RUN: Run %u finished", r.runId);
+}
+
+void runRecorderEvent(RunEvent code) {
+  if (!runRecorder.active)
+    return;
+  addRunRecord(RUN_REC_EVENT, code);
+  if (code == RUN_EV_ALARM)
+    flushRunRecords(); // alarm może poprzedzać reset - zapisujemy od razu
+}
+
+void processRunRecorder() {
+  RunRecorder &r = runRecorder;
+  if (r.active && millis() - r.lastSample >= RUN_SAMPLE_MS) {
+    r.lastSample += RUN_SAMPLE_MS;
+    addRunRecord(RUN_REC_SAMPLE, 0);
+  }
+}
+
+// --- HTTP ---
+
+/**
+ * @brief Records in an open chunk file, from its size.
+ */
+static uint32_t runChunkRecords(File &f) {
+  return f.size() > sizeof(RunFileHeader) ? (f.size() - sizeof(RunFileHeader)) / sizeof(RunRecord) : 0;
+}
+
+/**
+ * @brief Lists the runs as JSON: id, records, start time and file size.
+ */
+static void sendRunList(AsyncWebServerRequest *request) {
+  struct RunInfo {
+    uint32_t id;
+    uint32_t records;
+    uint32_t size;
+    uint32_t startTime;
+    uint16_t firstChunk;
+  } runs[RUNS_MAX * 2];
+  uint8_t count = 0;
+
+  Dir dir = LittleFS.openDir(RUN_DIR);
+  while (dir.next()) {
+    uint32_t id;
+    uint16_t chunk;
+    if (!parseRunFileName(dir.fileName(), id, chunk))
+      continue;
+    File f = dir.openFile("r");
+    RunFileHeader header;
+    if (f.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && header.magic == RUN_FILE_MAGIC &&
+        header.recordSize == sizeof(RunRecord)) {
+      uint8_t i = 0;
+      while (i < count && runs[i].id != id)
+        i++;
+      if (i == count && count < RUNS_MAX * 2)
+        runs[count++] = {id, 0, 0, header.startTime, chunk};
+      if (i < count) {
+        runs[i].records += runChunkRecords(f);
+        runs[i].size += f.size();
+        runs[i].firstChunk = min(runs[i].firstChunk, chunk);
+      }
+    }
+    f.close();
+  }
+
+  DynamicJsonDocument doc(1024);
+  doc[F("recording")] = runRecorder.active;
+  JsonArray list = doc.createNestedArray(F("runs"));
+  for (uint8_t i = 0; i < count; i++) {
+    JsonObject run = list.createNestedObject();
+    run[F("id")] = runs[i].id;
+    run[F("records")] = runs[i].records;
+    run[F("wrapped")] = runs[i].firstChunk > 0; // najstarsze chunki już usunięte
+    run[F("startTime")] = runs[i].startTime;
+    run[F("size")] = runs[i].size;
+  }
+
+  String output;
+  serializeJsonSmart(doc, output);
+  request->send(200, FPSTR(APPLICATION_JSON), output);
+}
+
+/**
+ * @brief Opens chunk s.chunk of the run and checks its header.
+ */
+static bool openRunCsvChunk(RunCsvStream &s) {
+  s.file = LittleFS.open(runFileName(s.id, s.chunk), "r");
+  RunFileHeader header;
+  return s.file && s.file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+         header.magic == RUN_FILE_MAGIC && header.recordSize == sizeof(RunRecord);
+}
+
+/**
+ * @brief Formats the next CSV line (header line first); false at the end.
+ */
+static bool nextRunCsvLine(RunCsvStream &s) {
+  s.linePos = 0;
+  if (!s.headerSent) {
+    s.headerSent = true;
+    s.lineLength = snprintf(s.line, sizeof(s.line), "t_ms,type,event,turns,rpm,abs_pos_mm,layer\n");
+    return true;
+  }
+
+  // Kolejne chunki czytamy po kolei; niepełny rekord na końcu = koniec chunka
+  RunRecord rec;
+  while (s.file.read((uint8_t *)&rec, sizeof(rec)) != sizeof(rec)) {
+    s.file.close();
+    if (s.chunk >= s.lastChunk)
+      return false;
+    s.chunk++;
+    if (!openRunCsvChunk(s))
+      return false;
+  }
+
+  s.lineLength = snprintf(s.line, sizeof(s.line), "%u,%s,%u,%.1f,%.1f,%.3f,%u\n", rec.t, rec.type == RUN_REC_EVENT ? "event" : "sample",
+                          rec.code, rec.turnsX10 / 10.0, rec.rpmX10 / 10.0, rec.absPosUm / 1000.0, rec.layer);
+  return true;
+}
+
+/**
+ * @brief Streams a run as CSV, one record at a time (no full copy in RAM).
+ */
+static void sendRunCsv(AsyncWebServerRequest *request, uint32_t id) {
+  if (id == runRecorder.runId && runRecorder.active)
+    flushRunRecords(); // żeby bieżący przebieg był kompletny
+
+  std::shared_ptr<RunCsvStream> s = std::make_shared<RunCsvStream>();
+  s->id = id;
+  if (!findRunChunks(id, s->chunk, s->lastChunk) || !openRunCsvChunk(*s)) {
+    request->send(404, FPSTR(APPLICATION_JSON), "{\"message\":\"no such run\"}");
+    return;
+  }
+
+  AsyncWebServerResponse *response =
+      request->beginChunkedResponse(F("text/csv"), [s](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+        size_t written = 0;
+        while (written < maxLen) {
+          if (s->linePos == s->lineLength && !nextRunCsvLine(*s))
+            break;
+          size_t n = min((size_t)(s->lineLength - s->linePos), maxLen - written);
+          memcpy(buffer + written, s->line + s->linePos, n);
+          s->linePos += n;
+          written += n;
+        }
+        return written; // 0 = koniec
+      });
+  response->addHeader("Content-Disposition", "attachment; filename=\"run" + String(id) + ".csv\"");
+  request->send(response);
+}
+
+/**
+ * @brief GET /api/runs lists the runs, /api/runs?id=N downloads one as CSV.
+ */
+void handleApiRuns(AsyncWebServerRequest *request) {
+  if (!fileSystemInitialized) {
+    request->send(500, "text/plain", "Internal Server Error: FS NOT INIT");
+    return;
+  }
+  if (request->hasParam("id"))
+    sendRunCsv(request, request->getParam("id")->value().toInt());
+  else
+    sendRunList(request);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file telemetry.h
+ * @brief Decoder for the Nano's binary telemetry frames (TELEMETRY ON).
+ *
+ * Frame on the wire: 0x00 <COBS(payload + CRC16)> 0x00, CRC-16/CCITT
+ * (poly 0x1021, init 0xFFFF), little endian fields. Layout mirrors
+ * telemetry.h of the Nano firmware.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#define TLM_STATUS 1 ///< Periodic machine snapshot
+#define TLM_EVENT 2  ///< One-off event {type, seq, code}
+
+#define TLM_F_LAYER_FWD 0x01 ///< layerDir == 1
+#define TLM_F_HOMED 0x02
+#define TLM_F_PAUSE_REQ 0x04
+#define TLM_F_HALTED 0x08
+
+#define TLM_STATUS_SIZE 24  ///< Status payload without CRC
+#define TLM_MAX_ENCODED 32  ///< Longer runs between zero bytes are not frames
+#define TLM_STALE_MS 2000   ///< Snapshot older than this is not reported
+
+/**
+ * @brief Last machine state decoded from the Nano.
+ */
+struct NanoTelemetry {
+  bool valid = false;          ///< At least one status frame received
+  unsigned long receivedAt = 0; ///< millis() of the last status frame
+  uint8_t state = 0;           ///< MachineState (0 = IDLE)
+  char motor = 0;              ///< 'W', 'T', 'S' or 0
+  uint8_t flags = 0;           ///< TLM_F_*
+  uint8_t queued = 0;          ///< Tasks in the Nano queue
+  int32_t currentSteps = 0;
+  int32_t targetSteps = 0;
+  float rpm = 0;
+  int32_t absPos = 0;          ///< Traverse steps from zero
+  uint16_t layer = 0;          ///< Layers finished since START
+  uint8_t lastEvent = 0;
+  uint8_t lastSeq = 0;
+  uint32_t frames = 0;         ///< Good frames
+  uint32_t badFrames = 0;      ///< CRC or length errors
+  uint32_t lostFrames = 0;     ///< Gaps in the sequence number
+};
+
+NanoTelemetry nanoTelemetry;
+
+/**
+ * @name Live samples
+ * Status frames are batched into binary WebSocket messages for live plots
+ * (decodeSamples() in kbWinder.js), little endian:
+ *
+ *   u8 type (WS_BIN_SAMPLES), u8 count, u32 t0 (ESP millis)
+ *   first sample: i32 rpm (RPM_Q), i32 absPos, i32 currentSteps, u16 layer
+ *   every next one: u8 dt (ms), i16 dRpm, i16 dAbsPos, i16 dSteps, i8 dLayer
+ *
+ * Deltas are against the previous sample. A sample that does not fit a
+ * delta starts a new message, so every message decodes on its own.
+ */
+///@{
+#define WS_BIN_SAMPLES 0x01
+#define SAMPLES_PER_MESSAGE 10   ///< 10 x 20 ms at TELEMETRY ON 20
+#define SAMPLES_MAX_AGE_MS 500   ///< Partial batch is sent after this
+#define SAMPLE_HEADER_SIZE 20
+#define SAMPLE_DELTA_SIZE 8
+#define SAMPLE_MESSAGE_MAX (SAMPLE_HEADER_SIZE + (SAMPLES_PER_MESSAGE - 1) * SAMPLE_DELTA_SIZE)
+
+struct SampleBatch {
+  uint8_t data[SAMPLE_MESSAGE_MAX];
+  uint8_t length = 0;
+  uint8_t count = 0;
+  unsigned long t0 = 0;
+  unsigned long lastTime = 0;
+  int32_t lastRpm = 0;
+  int32_t lastPos = 0;
+  int32_t lastSteps = 0;
+  uint16_t lastLayer = 0;
+};
+
+SampleBatch sampleBatch;
+///@}
+
+bool telemetryFeed(uint8_t c);
+void fillNanoTelemetry(JsonObject &root);
+void processTelemetrySamples();
+
+#endif
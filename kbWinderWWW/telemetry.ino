@@ -0,0 +1,223 @@
+/**
+ * @file telemetry.ino
+ * @brief Picks the Nano's binary telemetry frames out of the serial stream.
+ */
+
+#include "telemetry.h"
+
+/**
+ * @brief CRC-16/CCITT (poly 0x1021, init 0xFFFF), same as on the Nano.
+ */
+uint16_t telemetryCrc16(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static int32_t readLE32(const uint8_t *p) { return (int32_t)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24); }
+
+static uint8_t *writeLE(uint8_t *p, uint32_t v, uint8_t bytes) {
+  while (bytes--) {
+    *p++ = v & 0xFF;
+    v >>= 8;
+  }
+  return p;
+}
+
+static bool fitsInt16(int64_t v) { return v >= -32768 && v <= 32767; }
+
+/**
+ * @brief Sends the collected samples to all WebSocket clients.
+ */
+void flushSamples() {
+  SampleBatch &b = sampleBatch;
+  if (b.count == 0)
+    return;
+  b.data[1] = b.count;
+  broadcastBinary(b.data, b.length);
+  b.count = 0;
+  b.length = 0;
+}
+
+/**
+ * @brief Adds one status snapshot to the live sample batch.
+ */
+void addSample(int32_t rpm, int32_t absPos, int32_t steps, uint16_t layer) {
+  if (ws == nullptr || ws->count() == 0)
+    return;
+
+  SampleBatch &b = sampleBatch;
+  unsigned long now = millis();
+  // 64-bit: the difference of two int32 values can overflow int32
+  int64_t dRpm = (int64_t)rpm - b.lastRpm;
+  int64_t dPos = (int64_t)absPos - b.lastPos;
+  int64_t dSteps = (int64_t)steps - b.lastSteps;
+  int32_t dLayer = (int32_t)layer - b.lastLayer;
+  if (b.count > 0 && (now - b.lastTime > 255 || !fitsInt16(dRpm) || !fitsInt16(dPos) || !fitsInt16(dSteps) || dLayer < -128 || dLayer > 127))
+    flushSamples();
+
+  uint8_t *p = b.data + b.length;
+  if (b.count == 0) {
+    b.t0 = now;
+    *p++ = WS_BIN_SAMPLES;
+    *p++ = 0; // count, set by flushSamples()
+    p = writeLE(p, now, 4);
+    p = writeLE(p, rpm, 4);
+    p = writeLE(p, absPos, 4);
+    p = writeLE(p, steps, 4);
+    p = writeLE(p, layer, 2);
+  } else {
+    *p++ = (uint8_t)(now - b.lastTime);
+    p = writeLE(p, dRpm, 2);
+    p = writeLE(p, dPos, 2);
+    p = writeLE(p, dSteps, 2);
+    *p++ = (uint8_t)dLayer;
+  }
+  b.length = p - b.data;
+  b.count++;
+  b.lastTime = now;
+  b.lastRpm = rpm;
+  b.lastPos = absPos;
+  b.lastSteps = steps;
+  b.lastLayer = layer;
+
+  if (b.count == SAMPLES_PER_MESSAGE)
+    flushSamples();
+}
+
+/**
+ * @brief Sends a partial batch once it gets old (telemetry slow or off).
+ */
+void processTelemetrySamples() {
+  if (sampleBatch.count > 0 && millis() - sampleBatch.t0 >= SAMPLES_MAX_AGE_MS)
+    flushSamples();
+}
+
+/**
+ * @brief Decodes one COBS frame (delimiters stripped) into nanoTelemetry.
+ * @return false if it is not a valid frame (bad COBS, length or CRC).
+ */
+bool telemetryDecode(const uint8_t *frame, size_t len) {
+  uint8_t raw[TLM_MAX_ENCODED];
+  size_t rawLen = 0;
+  for (size_t i = 0; i < len;) {
+    uint8_t code = frame[i++];
+    if (code == 0 || i + code - 1 > len)
+      return false;
+    for (uint8_t k = 1; k < code; k++)
+      raw[rawLen++] = frame[i++];
+    if (code < 0xFF && i < len)
+      raw[rawLen++] = 0;
+  }
+  if (rawLen < 3 + 2)
+    return false;
+  rawLen -= 2;
+  if (telemetryCrc16(raw, rawLen) != (uint16_t)(raw[rawLen] | raw[rawLen + 1] << 8))
+    return false;
+
+  NanoTelemetry &t = nanoTelemetry;
+  uint8_t seq = raw[1];
+  if (t.frames > 0)
+    t.lostFrames += (uint8_t)(seq - t.lastSeq - 1);
+  t.lastSeq = seq;
+
+  if (raw[0] == TLM_STATUS && rawLen == TLM_STATUS_SIZE) {
+    t.state = raw[2];
+    t.motor = (char)raw[3];
+    t.flags = raw[4];
+    t.queued = raw[5];
+    t.currentSteps = readLE32(raw + 6);
+    t.targetSteps = readLE32(raw + 10);
+    t.rpm = (uint32_t)readLE32(raw + 14) / 256.0f; // RPM_Q() on the Nano
+    t.absPos = readLE32(raw + 18);
+    t.layer = raw[22] | raw[23] << 8;
+    t.receivedAt = millis();
+    t.valid = true;
+    addSample(readLE32(raw + 14), t.absPos, t.currentSteps, t.layer);
+  } else if (raw[0] == TLM_EVENT) {
+    t.lastEvent = raw[2];
+    updateWsStatusPending = true; // push events to the UI right away
+    logMessagef(LOG_LEVEL_DEBUG, "Nano event %u", raw[2]);
+  } else {
+    return false;
+  }
+  t.frames++;
+  return true;
+}
+
+/**
+ * @brief Feeds one byte from the Nano UART to the frame decoder.
+ *
+ * Text never contains 0x00, so everything between two zero bytes is a frame.
+ * A run that fails to decode may have been text seen after a missed
+ * delimiter: the zero is then taken as the start of the next frame, which
+ * resynchronises on the first good one.
+ *
+ * @return true if the byte belonged to a frame, false if it is console text.
+ */
+bool telemetryFeed(uint8_t c) {
+  static uint8_t frame[TLM_MAX_ENCODED];
+  static size_t frameLen = 0;
+  static bool inFrame = false;
+
+  if (c == 0) {
+    if (inFrame && frameLen > 0) {
+      if (telemetryDecode(frame, frameLen))
+        inFrame = false;
+      else
+        nanoTelemetry.badFrames++;
+    } else {
+      inFrame = true;
+    }
+    frameLen = 0;
+    return true;
+  }
+  if (!inFrame)
+    return false;
+  if (frameLen < sizeof(frame)) {
+    frame[frameLen++] = c;
+    return true;
+  }
+  // Too long for a frame: it was text after a stray zero byte
+  inFrame = false;
+  frameLen = 0;
+  nanoTelemetry.badFrames++;
+  return false;
+}
+
+/**
+ * @brief Adds the last decoded Nano state to a status JSON as "nano".
+ * Skipped while telemetry is off or the last frame is stale.
+ */
+void fillNanoTelemetry(JsonObject &root) {
+  const NanoTelemetry &t = nanoTelemetry;
+  if (!t.valid || millis() - t.receivedAt > TLM_STALE_MS)
+    return;
+
+  JsonObject nano = root.createNestedObject(F("nano"));
+  nano[F("state")] = t.state;
+  if (t.motor != 0)
+    nano[F("motor")] = String(t.motor);
+  nano[F("queued")] = t.queued;
+  nano[F("currentSteps")] = t.currentSteps;
+  nano[F("targetSteps")] = t.targetSteps;
+  nano[F("rpm")] = t.rpm;
+  nano[F("absPos")] = t.absPos;
+  nano[F("layer")] = t.layer;
+  nano[F("layerDir")] = (t.flags & TLM_F_LAYER_FWD) ? 1 : -1;
+  nano[F("homed")] = (t.flags & TLM_F_HOMED) != 0;
+  nano[F("pauseRequested")] = (t.flags & TLM_F_PAUSE_REQ) != 0;
+  nano[F("halted")] = (t.flags & TLM_F_HALTED) != 0;
+  nano[F("lastEvent")] = t.lastEvent;
+  nano[F("age")] = millis() - t.receivedAt;
+
+  if (configuration.system.webDebugEnabled) {
+    nano[F("frames")] = t.frames;
+    nano[F("badFrames")] = t.badFrames;
+    nano[F("lostFrames")] = t.lostFrames;
+  }
+}
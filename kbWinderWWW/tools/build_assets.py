@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Prepares kbWinderWWW/data for the LittleFS image.
+
+- every static asset gets a gzipped copy (<name>.gz) that the ESP serves
+  with Content-Encoding: gzip,
+- references to local assets in the HTML pages get a ?v=<hash> suffix, so
+  those assets can be cached forever (immutable) and still change on update,
+- assets.manifest lists "<url> <file> <etag> <immutable>" per asset; the ESP
+  loads it at boot instead of probing LittleFS on every request.
+
+Run it before "Upload LittleFS", e.g.:  python3 tools/build_assets.py
+The originals stay in data/ (fallback when there is no manifest); delete
+them from the image if flash gets tight.
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+DATA_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data")
+MANIFEST = "assets.manifest"
+COMPRESS = (".html", ".js", ".css", ".svg", ".json", ".h", ".txt")
+SKIP = ("configuration.json", "ncsi.txt")  # runtime file / plain captive probe
+REFERENCE = re.compile(r'((?:href|src)=")([^"?#:]+)(")')
+
+
+def content_hash(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def main():
+    data_dir = os.path.normpath(sys.argv[1] if len(sys.argv) > 1 else DATA_DIR)
+    names = sorted(
+        n
+        for n in os.listdir(data_dir)
+        if os.path.isfile(os.path.join(data_dir, n))
+        and n.endswith(COMPRESS)
+        and n not in SKIP
+        and n != MANIFEST
+    )
+
+    contents = {}
+    for name in names:
+        with open(os.path.join(data_dir, name), "rb") as f:
+            contents[name] = f.read()
+
+    # Assets first: their hashes go into the pages referencing them
+    hashes = {n: content_hash(c) for n, c in contents.items() if not n.endswith(".html")}
+    versioned = set()
+
+    def add_version(match):
+        ref = match.group(2).lstrip("/")
+        if ref not in hashes:
+            return match.group(0)
+        versioned.add(ref)
+        return f"{match.group(1)}{match.group(2)}?v={hashes[ref][:8]}{match.group(3)}"
+
+    for name in names:
+        if name.endswith(".html"):
+            page = contents[name].decode("utf-8")
+            contents[name] = REFERENCE.sub(add_version, page).encode("utf-8")
+            hashes[name] = content_hash(contents[name])
+
+    lines = []
+    total_raw = total_gz = 0
+    for name in names:
+        packed = gzip.compress(contents[name], compresslevel=9, mtime=0)
+        with open(os.path.join(data_dir, name + ".gz"), "wb") as f:
+            f.write(packed)
+        immutable = 1 if name in versioned else 0
+        lines.append(f"/{name} /{name}.gz {hashes[name]} {immutable}")
+        total_raw += len(contents[name])
+        total_gz += len(packed)
+        print(f"{name:20} {len(contents[name]):7} -> {len(packed):6}  {hashes[name]}{'  immutable' if immutable else ''}")
+
+    with open(os.path.join(data_dir, MANIFEST), "w", newline="\n") as f:
+        f.write("\n".join(lines) + "\n")
+    print(f"{len(names)} assets, {total_raw} -> {total_gz} bytes, {MANIFEST} written")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief One entry of the static asset index, built at boot from
+ * data/assets.manifest (tools/build_assets.py) or a directory scan.
+ */
+struct StaticAsset {
+  String url;     ///< "/kbWinder.js"
+  String file;    ///< "/kbWinder.js.gz", served with Content-Encoding: gzip
+  String etag;    ///< Content hash from the manifest, empty = unknown
+  bool immutable; ///< Versioned by the pages (?v=<hash>)
+};
+
+std::vector<StaticAsset> staticAssets;
+
+void loadStaticAssetIndex();
+
 void processCommandQueue();
+void handleNanoAck(uint8_t seq);
 void handleUpdateWsStatusPending();
\ No newline at end of file
@@ -12,6 +12,7 @@ void initializeWebServer() {
     ws = new AsyncWebSocket("/ws");
 
   initializeWebSockets();
+  loadStaticAssetIndex();
 
   logMessage(LOG_LEVEL_INFO, F("Initializing HTTP: Async Web Server..."));
 
@@ -140,6 +141,7 @@ void registerRoutes() {
     }
     request->send(404, "text/plain", "File not found");
   }));
+  server->on("/api/runs", HTTP_GET, withAuth(handleApiRuns));
   server->on("/api/list-files", HTTP_GET, withLock(withAuth(handleApiListFiles)));
   server->on("/api/delete-file", HTTP_GET, withLock(withAuth(handleApiFileDelete)));
   // --- Not Found ---
@@ -162,30 +164,75 @@ void handleNotFoundAsync(AsyncWebServerRequest *request) {
 }
 
 /**
- * @brief Handler API zwracający listę plików oraz statystyki systemu plików.
+ * @brief Walks LittleFS with an explicit directory stack and emits the
+ * "/api/list-files" JSON one file entry at a time.
  */
-void handleApiListFiles(AsyncWebServerRequest *request) {
-  // 1. Alokacja dokumentu (4KB wystarczy na ok. 30-40 plików w liście)
-  DynamicJsonDocument doc(4096);
+struct FileListJsonSource : JsonChunkSource {
+  Dir dirs[LIST_FILES_MAX_DEPTH];
+  String paths[LIST_FILES_MAX_DEPTH];
+  uint8_t depth = 0;
+  uint8_t step = 0;
+
+  bool nextPiece() override {
+    if (step == 0) {
+      step = 1;
+      dirs[0] = LittleFS.openDir("/");
+      paths[0] = "/";
+      depth = 1;
+
+      FSInfo fs_info;
+      if (LittleFS.info(fs_info)) {
+        snprintf(piece, sizeof(piece), "{\"totalBytes\":%u,\"usedBytes\":%u,\"freeBytes\":%u,\"usagePercent\":%u,\"files\":[",
+                 fs_info.totalBytes, fs_info.usedBytes, fs_info.totalBytes - fs_info.usedBytes,
+                 (fs_info.usedBytes * 100) / fs_info.totalBytes);
+        pieceLength = strlen(piece);
+        piecePos = 0;
+        return true;
+      }
+      return setPiece("{\"files\":[");
+    }
 
-  // 2. Pobieranie statystyk systemu plików
-  FSInfo fs_info;
-  if (LittleFS.info(fs_info)) {
-    doc["totalBytes"] = fs_info.totalBytes;
-    doc["usedBytes"] = fs_info.usedBytes;
-    doc["freeBytes"] = fs_info.totalBytes - fs_info.usedBytes;
-    doc["usagePercent"] = (fs_info.usedBytes * 100) / fs_info.totalBytes;
-  }
+    while (step == 1 && depth > 0) {
+      Dir &dir = dirs[depth - 1];
+      if (!dir.next()) {
+        dir = Dir(); // zwalniamy katalog
+        depth--;
+        continue;
+      }
+      String fullPath = paths[depth - 1] + dir.fileName();
+      if (dir.isDirectory()) {
+        if (depth < LIST_FILES_MAX_DEPTH) {
+          paths[depth] = fullPath + "/";
+          dirs[depth] = LittleFS.openDir(paths[depth]);
+          depth++;
+        }
+        continue;
+      }
 
-  // 3. Budowanie listy plików (rekurencyjnie)
-  JsonArray files = doc.createNestedArray("files");
-  walkFS("/", &files);
+      File f = dir.openFile("r");
+      time_t lw = f.getLastWrite();
+      f.close();
 
-  // 4. Inteligentna serializacja i wysyłka
-  String output;
-  serializeJsonSmart(doc, output);
-  request->send(200, FPSTR(APPLICATION_JSON), output);
-}
+      StaticJsonDocument<256> entry;
+      entry["name"] = fullPath;
+      entry["size"] = dir.fileSize();
+      entry["lastWrite"] = lw;
+      return setElement(entry);
+    }
+
+    if (step == 1) {
+      step = 2;
+      return setPiece("]}");
+    }
+    return false;
+  }
+};
+
+/**
+ * @brief Handler API zwracający listę plików oraz statystyki systemu plików.
+ * Lista jest wysyłana w kawałkach w trakcie przechodzenia po katalogach.
+ */
+void handleApiListFiles(AsyncWebServerRequest *request) { sendChunkedJson(request, std::make_shared<FileListJsonSource>()); }
 
 /**
  * @brief Handler API do bezpiecznego usuwania plików z LittleFS.
@@ -271,23 +318,75 @@ void handleCommandAsync(AsyncWebServerRequest *request) {
 
 void sendCommand(String command) { logMessage(LOG_LEVEL_SENDCMD, command); }
 
-void processCommandQueue() {
-  if (commandQueue.empty())
+/**
+ * @brief Sends a queued command tagged with its sequence number.
+ * The web console gets the plain command, the Nano the "#<seq> " prefix too.
+ * @return Bytes written to the UART.
+ */
+uint8_t sendTaggedCommand(uint8_t seq, const String &command) {
+  uint8_t length = 0;
+  if (serialInitialized)
+    length = DEBUG_UART.printf("#%u %s\n", seq, command.c_str());
+  if (LOG_LEVEL_SENDCMD <= configuration.system.webLogLevel)
+    broadcastLog(LOG_LEVEL_SENDCMD, command.c_str());
+  return length;
+}
+
+/**
+ * @brief Returns the credits of every command up to and including seq.
+ * Acks arrive in order, so older entries still in flight lost their ack.
+ * An ack for a seq not in flight (late, after the timeout dropped it) is
+ * ignored: newer commands may still sit in the Nano's RX buffer.
+ */
+void handleNanoAck(uint8_t seq) {
+  bool known = false;
+  for (const InFlightCommand &c : commandsInFlight) {
+    if (c.seq == seq) {
+      known = true;
+      break;
+    }
+  }
+  if (!known) {
+    logMessagef(LOG_LEVEL_DEBUG, "Queue: ignoring ACK %u, not in flight", seq);
     return;
+  }
 
-  unsigned long now = millis();
-  // Wysyłamy kolejną komendę tylko, jeśli minął czas COMMAND_SPACING_MS
-  if (now - lastCommandSentTime >= COMMAND_SPACING_MS) {
-    String cmd = commandQueue.front();
-    commandQueue.pop_front();
+  while (!commandsInFlight.empty()) {
+    InFlightCommand done = commandsInFlight.front();
+    commandsInFlight.pop_front();
+    bytesInFlight -= done.length;
+    if (done.seq == seq)
+      return;
+  }
+}
 
-    // Fizyczne wysłanie do Nano
-    sendCommand(cmd);
+void processCommandQueue() {
+  unsigned long now = millis();
 
-    lastCommandSentTime = now;
+  // Nano nie odpowiada (reset, zgubiony ACK) - zwalniamy kredyty
+  if (!commandsInFlight.empty() && now - commandsInFlight.front().sentAt >= COMMAND_ACK_TIMEOUT_MS) {
+    logMessagef(LOG_LEVEL_WARNING, "Queue: no ACK from Nano for #%u, dropping %u in flight", commandsInFlight.front().seq,
+                (unsigned)commandsInFlight.size());
+    commandsInFlight.clear();
+    bytesInFlight = 0;
+  }
 
-    // Opcjonalnie: logowanie postępu (bezpieczne, bo jesteśmy w loop)
-    logMessagef(LOG_LEVEL_DEBUG, "Queue: Sent to Nano [%s], left in queue: %d", cmd.c_str(), commandQueue.size());
+  // Wysyłamy tyle komend, ile zmieści się w buforze Nano.
+  // Komenda dłuższa niż okno idzie sama, gdy nic nie czeka na ACK.
+  while (!commandQueue.empty()) {
+    const String &cmd = commandQueue.front();
+    uint16_t length = cmd.length() + 6; // "#255 " + '\n'
+    if (!commandsInFlight.empty() && bytesInFlight + length > NANO_RX_WINDOW)
+      break;
+
+    uint8_t seq = commandSeq++;
+    length = sendTaggedCommand(seq, cmd);
+    commandsInFlight.push_back({seq, (uint8_t)length, now});
+    bytesInFlight += length;
+
+    logMessagef(LOG_LEVEL_DEBUG, "Queue: Sent to Nano #%u [%s], left in queue: %u", seq, cmd.c_str(),
+                (unsigned)(commandQueue.size() - 1));
+    commandQueue.pop_front();
 
     updateWsStatusPending = true;
     blink(1);
@@ -301,10 +400,44 @@ void handleUpdateWsStatusPending() {
   }
 }
 
+/**
+ * @brief Emits the configuration JSON one section at a time: "info", then
+ * every configuration section. Peak memory is one section document.
+ */
+struct ConfigJsonSource : JsonChunkSource {
+  bool isPublic = true;
+  uint8_t step = 0;
+
+  bool nextPiece() override {
+    uint8_t current = step++;
+    if (current == 0)
+      return setPiece("{");
+    if (current == MainConfiguration::SECTION_COUNT + 2)
+      return setPiece("}");
+    if (current > MainConfiguration::SECTION_COUNT + 2)
+      return false;
+
+    DynamicJsonDocument doc(JSON_SECTION_DOC_SIZE);
+    if (current == 1) {
+      softwareInfo.toJson(doc.createNestedObject(F("info")));
+    } else {
+      uint8_t index = current - 2;
+      const char *name = MainConfiguration::sectionName(index);
+      JsonObject section = doc.createNestedObject(name);
+      configuration.sectionToJson(index, section, isPublic, true); // true = mask Passwords, as we're on the web
+
+      // Help JS identify the current IP (important for captive portal redirects)
+      if (strcmp(name, "network") == 0)
+        section[F("activeLocalIp")] = WiFi.localIP().toString();
+    }
+    return setMembers(doc);
+  }
+};
+
 /**
  * @brief Serves the complete system configuration and metadata as JSON.
- * Masks sensitive passwords and includes system limits for the UI.
- * Uses AsyncResponseStream for memory safety on large JSON payloads.
+ * Masks sensitive passwords for unauthorized clients.
+ * Sent as a chunked response, one section at a time.
  */
 void handleGetConfigurationAsync(AsyncWebServerRequest *request) {
   bool isAuthorized = false;
@@ -321,111 +454,65 @@ void handleGetConfigurationAsync(AsyncWebServerRequest *request) {
 
   logMessagef(LOG_LEVEL_DEBUG, "API: Serving configuration (Authorized: %s)", isAuthorized ? "YES" : "NO");
 
-  // 3. Optymalizacja RAM: mniejszy dokument dla wersji publicznej
-  size_t capacity = isAuthorized ? 6144 : 4096;
-  DynamicJsonDocument doc(capacity);
-  JsonObject root = doc.to<JsonObject>();
-
-  if (doc.capacity() == 0) {
-    logMessage(LOG_LEVEL_ERROR, F("API: JSON allocation failed!"));
-    request->send(500, FPSTR(TEXT_PLAIN), F("Internal Server Error: Out of memory"));
-    return;
-  }
-
-  softwareInfo.toJson(root.createNestedObject(F("info")));
-  configuration.toJson(root, !isAuthorized, true); // true = mask Passwords, as we're on the web
-
-  // Help JS identify the current IP (important for captive portal redirects)
-  root[F("network")][F("activeLocalIp")] = WiFi.localIP().toString();
-
-  if (isAuthorized) {
-    // --- 3. METADATA ---
-    // JsonObject meta = root.createNestedObject("meta");
-    // meta[F("maxMidiControllers")] = LogicConfiguration::MAX_MIDI_CONTROLLERS;
-  }
-
-  logMessagef(LOG_LEVEL_DEBUG, PSTR("JSON Capacity: %d, Used: %d"), doc.capacity(), doc.memoryUsage());
-
-  // We use a stream to avoid allocating a massive temporary String
-  AsyncResponseStream *response = request->beginResponseStream(FPSTR(APPLICATION_JSON));
-  // Write directly to the response stream
-  serializeJsonSmart(doc, *response);
-  // Finalize the request
-  request->send(response);
+  std::shared_ptr<ConfigJsonSource> source = std::make_shared<ConfigJsonSource>();
+  source->isPublic = !isAuthorized;
+  sendChunkedJson(request, source);
 }
 
 /**
  * @brief Handles POST request to save configuration.
- * Collects chunks of data, parses JSON, and saves to file.
+ * The body is scanned as it arrives (jsonstream.ino): each section of
+ * "values" is applied to a staged copy when complete, so only one section is
+ * buffered. On the last chunk the staged copy is applied and saved.
  */
 void handleSaveConfigurationAsync(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-  // 1. Inicjalizacja bufora przy pierwszym kawałku
-  // Używamy statycznego Stringa, aby zbierać dane z kolejnych wywołań callbacka
-  static String bodyBuffer = "";
+  // 1. Nowy parser przy pierwszym kawałku
   if (index == 0) {
-    bodyBuffer = "";
-    bodyBuffer.reserve(total); // Optymalizacja pamięci
     logMessage(LOG_LEVEL_INFO, "API: Receiving new configuration...");
+    beginConfigBody();
   }
 
-  // 2. Dopisywanie danych do bufora
-  for (size_t i = 0; i < len; i++) {
-    bodyBuffer += (char)data[i];
-  }
+  // 2. Przetwarzanie kawałka od razu - bez zbierania całego body
+  feedConfigBody(data, len);
 
   // 3. Sprawdzenie, czy odebraliśmy już wszystko
   if (index + len == total) {
-    DynamicJsonDocument doc(8192);
-    DeserializationError error = deserializeJson(doc, bodyBuffer);
-
-    if (error) {
-      logMessagef(LOG_LEVEL_ERROR, "API: JSON Parse failed: %s", error.c_str());
-      request->send(400, FPSTR(APPLICATION_JSON), "{\"message\":\"Invalid JSON\"}");
-      bodyBuffer = ""; // Czyścimy bufor
-      return;
-    }
-
-    // 4. Walidacja struktury (szukamy klucza "values")
-    JsonObject values = doc["values"];
-    if (values.isNull()) {
-      logMessage(LOG_LEVEL_ERROR, "API: Missing 'values' object in POST");
-      request->send(400, FPSTR(APPLICATION_JSON), "{\"message\":\"Missing 'values' object\"}");
-      bodyBuffer = "";
+    const char *error = finishConfigBody();
+    if (error != nullptr) {
+      logMessagef(LOG_LEVEL_ERROR, "API: Configuration rejected: %s", error);
+      DynamicJsonDocument errorDoc(128);
+      errorDoc["message"] = error;
+      String response;
+      serializeJson(errorDoc, response);
+      request->send(strcmp(error, "Out of memory") == 0 ? 500 : 400, FPSTR(APPLICATION_JSON), response);
       return;
     }
 
     printSerialLogLevel();
-    logMessage(LOG_LEVEL_VERBOSE, bodyBuffer);
 
-    // 5. Aplikowanie konfiguracji
-    if (configuration.fromJson(values)) {
-      bool saved = configuration.saveToFile();
+    // 4. Zapis zastosowanej konfiguracji
+    bool saved = configuration.saveToFile();
 
-      if (saved) {
-        logMessage(LOG_LEVEL_NOTICE, F("Config: Applying network settings dynamically..."));
-        initializeWiFi(false);
+    if (saved) {
+      logMessage(LOG_LEVEL_NOTICE, F("Config: Applying network settings dynamically..."));
+      initializeWiFi(false);
 
-        // Budujemy odpowiedź (zgodnie z Twoim wymogiem: status, message, IP)
-        DynamicJsonDocument responseDoc(256);
-        responseDoc["status"] = "ok";
-        responseDoc["message"] = "Configuration saved. Connecting to WiFi in background...";
+      // Budujemy odpowiedź (zgodnie z Twoim wymogiem: status, message, IP)
+      DynamicJsonDocument responseDoc(256);
+      responseDoc["status"] = "ok";
+      responseDoc["message"] = "Configuration saved. Connecting to WiFi in background...";
 
-        String response;
-        serializeJsonSmart(responseDoc, response);
-        request->send(200, FPSTR(APPLICATION_JSON), response);
+      String response;
+      serializeJsonSmart(responseDoc, response);
+      request->send(200, FPSTR(APPLICATION_JSON), response);
 
-        logMessage(LOG_LEVEL_NOTICE, F("Config: Saved. Restart is needed for network/services changes."));
+      logMessage(LOG_LEVEL_NOTICE, F("Config: Saved. Restart is needed for network/services changes."));
 
-        // Opcjonalny restart (bezpiecznie po rozłączeniu klienta)
-        // request->onDisconnect([](){ ESP.restart(); });
-      } else {
-        request->send(500, FPSTR(APPLICATION_JSON), "{\"status\":\"error\",\"message\":\"Failed to write to FS\"}");
-      }
+      // Opcjonalny restart (bezpiecznie po rozłączeniu klienta)
+      // request->onDisconnect([](){ ESP.restart(); });
     } else {
-      request->send(500, FPSTR(APPLICATION_JSON), "{\"status\":\"error\",\"message\":\"Validation failed\"}");
+      request->send(500, FPSTR(APPLICATION_JSON), "{\"status\":\"error\",\"message\":\"Failed to write to FS\"}");
     }
-
-    bodyBuffer = ""; // Czyszczenie na samym końcu
   }
 }
 
@@ -549,40 +636,32 @@ void handleStaticFile(AsyncWebServerRequest *request, String overridePath) {
     return;
   }
 
-  // Inteligentne szukanie plików (.html, .gz)
-  String finalPath = path;
-  bool found = LittleFS.exists(finalPath);
-
-  if (!found && !finalPath.endsWith(".html") && !finalPath.endsWith(".css") && !finalPath.endsWith(".js")) {
-    if (LittleFS.exists(finalPath + ".html")) {
-      finalPath += ".html";
-      found = true;
-    }
-  }
+  // Plik z indeksu w RAM - bez sprawdzania LittleFS.exists()
+  const StaticAsset *asset = findStaticAsset(path);
+  bool notFoundPage = (overridePath == FPSTR(PATH_404_HTML));
 
-  if (!found && !finalPath.endsWith(".gz")) {
-    if (LittleFS.exists(finalPath + ".gz")) {
-      finalPath += ".gz";
-      found = true;
-    }
+  if (asset != nullptr && !request->hasArg("download")) {
+    sendStaticAsset(request, *asset, notFoundPage);
+    return;
   }
 
-  // 4. Wysyłanie odpowiedzi
-  if (found) {
+  // Poza indeksem (np. pliki zapisane po starcie) albo pobieranie
+  String finalPath = (asset != nullptr) ? asset->file : path;
+  if (asset != nullptr || LittleFS.exists(finalPath)) {
     if (request->hasArg("download")) {
       AsyncWebServerResponse *response = request->beginResponse(LittleFS, finalPath, "application/octet-stream");
       response->addHeader("Content-Disposition", "attachment");
       request->send(response);
     } else {
       AsyncWebServerResponse *response = request->beginResponse(LittleFS, finalPath);
-      if (overridePath == FPSTR(PATH_404_HTML)) {
+      if (notFoundPage) {
         response->setCode(404);
       }
       request->send(response);
     }
   } else {
     // Obsługa braku pliku
-    if (overridePath == PATH_404_HTML) {
+    if (notFoundPage) {
       logMessage(LOG_LEVEL_ERROR, "FS: Critical - 404 file missing!");
       request->send(404, "text/html", "<html><body><h1>404 Not Found</h1></body></html>");
     } else {
@@ -592,6 +671,99 @@ void handleStaticFile(AsyncWebServerRequest *request, String overridePath) {
   }
 }
 
+/**
+ * @brief Builds the static asset index from /assets.manifest.
+ * Without a manifest the root directory is scanned instead: plain files
+ * win over their .gz copies (as before) and there are no ETags.
+ */
+void loadStaticAssetIndex() {
+  staticAssets.clear();
+  if (!fileSystemInitialized)
+    return;
+
+  File manifest = LittleFS.open("/assets.manifest", "r");
+  if (manifest) {
+    // "<url> <file> <etag> <immutable>" per line
+    while (manifest.available()) {
+      String line = manifest.readStringUntil('\n');
+      line.trim();
+      int a = line.indexOf(' ');
+      int b = line.indexOf(' ', a + 1);
+      int c = line.indexOf(' ', b + 1);
+      if (a <= 0 || b <= a || c <= b)
+        continue;
+      staticAssets.push_back({line.substring(0, a), line.substring(a + 1, b), line.substring(b + 1, c), line.substring(c + 1) == "1"});
+    }
+    manifest.close();
+    logMessagef(LOG_LEVEL_INFO, "FS: %u assets from manifest", staticAssets.size());
+    return;
+  }
+
+  std::vector<String> names;
+  Dir dir = LittleFS.openDir("/");
+  while (dir.next()) {
+    if (dir.isFile())
+      names.push_back("/" + dir.fileName());
+  }
+  for (const String &name : names) {
+    if (!name.endsWith(".gz")) {
+      staticAssets.push_back({name, name, String(), false});
+      continue;
+    }
+    String url = name.substring(0, name.length() - 3);
+    if (std::find(names.begin(), names.end(), url) == names.end())
+      staticAssets.push_back({url, name, String(), false});
+  }
+  logMessagef(LOG_LEVEL_WARNING, "FS: No assets.manifest, %u files indexed without ETags", staticAssets.size());
+}
+
+/**
+ * @brief Looks a URL up in the asset index; "/setup" also finds "/setup.html".
+ */
+const StaticAsset *findStaticAsset(const String &path) {
+  bool tryHtml = !path.endsWith(".html") && !path.endsWith(".css") && !path.endsWith(".js");
+  String htmlPath = path + ".html";
+  for (const StaticAsset &asset : staticAssets) {
+    if (asset.url == path || (tryHtml && asset.url == htmlPath))
+      return &asset;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Sends an indexed asset with ETag and caching headers, or 304.
+ * Versioned requests (?v=) of immutable assets are cached for a year,
+ * everything else is revalidated (cheap: a 304 without a body).
+ */
+void sendStaticAsset(AsyncWebServerRequest *request, const StaticAsset &asset, bool notFoundPage) {
+  bool cacheable = asset.etag.length() > 0 && !notFoundPage;
+  String etag = "\"" + asset.etag + "\"";
+  const char *cacheControl = (asset.immutable && request->hasParam("v")) ? "public, max-age=31536000, immutable" : "no-cache";
+
+  if (cacheable && request->hasHeader("If-None-Match") && request->header("If-None-Match").indexOf(etag) >= 0) {
+    AsyncWebServerResponse *response = request->beginResponse(304);
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+    return;
+  }
+
+  File file = LittleFS.open(asset.file, "r");
+  if (!file) {
+    request->send(500, "text/plain", "Internal Server Error: asset missing");
+    return;
+  }
+  // Plik .gz wysłany pod nazwą bez .gz - biblioteka sama dodaje Content-Encoding: gzip
+  AsyncWebServerResponse *response = request->beginResponse(file, asset.url);
+  if (notFoundPage) {
+    response->setCode(404);
+  } else if (cacheable) {
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", cacheControl);
+  }
+  request->send(response);
+}
+
 /**
  * @brief Provides a snapshot of the current system state for the UI.
  */
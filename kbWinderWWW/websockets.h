@@ -0,0 +1,88 @@
+/**
+ * @file websockets.h
+ * @brief Per-client outbound queues for the WebSocket.
+ *
+ * Nothing is written to a client directly from the log or status paths.
+ * Messages go to the client's outbox, and processWsOutboxes() sends only
+ * as much as that client can take right now, so a slow phone never stalls
+ * loop() or the other clients.
+ *
+ * - Status messages coalesce: the newest one is sent from the cache.
+ * - Binary live samples keep the newest few messages.
+ * - When the log queue is full, the oldest of the most verbose lines is
+ *   dropped.
+ * - Critical lines (ERROR, ALWAYS, Nano "ERROR"/"ALARM") are never dropped.
+ *   A client that cannot even keep up with those is disconnected.
+ */
+
+#ifndef WEBSOCKETS_H
+#define WEBSOCKETS_H
+
+#include <Arduino.h>
+#include <AsyncWebSocket.h>
+#include <deque>
+#include <vector>
+
+#include <ArduinoJson.h>
+
+#include "debug.h"
+
+#define WS_OUTBOX_LOG_LINES 16  ///< Queued lines before dropping starts
+#define WS_OUTBOX_HARD_LIMIT 32 ///< Critical lines only; beyond this: disconnect
+#define WS_OUTBOX_SAMPLES 4     ///< Binary sample messages, oldest dropped
+
+struct WsQueuedLog {
+  LogLevel level;
+  bool critical; ///< Never dropped
+  String json;
+};
+
+struct WsOutbox {
+  uint32_t clientId;
+  bool statusPending; ///< Send the newest cached status (see StatusCache)
+  bool statusFull;    ///< ...the full one
+  std::deque<WsQueuedLog> logs;
+  std::deque<std::vector<uint8_t>> samples; ///< Binary live samples
+};
+
+std::deque<WsOutbox> wsOutboxes;
+uint32_t wsDroppedMessages = 0; ///< Messages dropped for slow clients
+
+/**
+ * @name Status cache
+ * Status JSON is built in one static arena and serialized into a static
+ * buffer (minimal and full). Broadcasts rebuild it. /api/status and new
+ * clients reuse it while it is younger than STATUS_CACHE_MS. Outboxes only
+ * hold a flag and send from the shared buffer, so a status costs no heap
+ * on our side however many clients are connected.
+ *
+ * The sizes are the bench's worst case (checkStatusWorstCase(): the GET
+ * dump cache full to its WINDER_SETTINGS_MAX bounds, debug fields, longest
+ * alarm, hostname and SSIDs) plus a little margin: 6.5 KB of static RAM in
+ * exchange for no heap churn per broadcast. A status that still does not
+ * fit is replaced by a short one flagged "truncated", never cut mid-JSON.
+ */
+///@{
+#define STATUS_ARENA_SIZE 2304        ///< Worst case 2153
+#define STATUS_JSON_MINIMAL_SIZE 1152 ///< Worst case 1079 (compact)
+#define STATUS_JSON_FULL_SIZE 3072    ///< Worst case 2948 (compact)
+#define STATUS_CACHE_MS 500
+
+struct StatusCache {
+  char minimalJson[STATUS_JSON_MINIMAL_SIZE];
+  char fullJson[STATUS_JSON_FULL_SIZE];
+  char *const json[2] = {minimalJson, fullJson}; ///< [0] minimal, [1] full
+  const size_t size[2] = {STATUS_JSON_MINIMAL_SIZE, STATUS_JSON_FULL_SIZE};
+  size_t length[2] = {0, 0};
+  unsigned long builtAt[2] = {0, 0};
+};
+
+StaticJsonDocument<STATUS_ARENA_SIZE> statusArena;
+StatusCache statusCache;
+///@}
+
+WsOutbox &getWsOutbox(uint32_t clientId);
+void broadcastBinary(const uint8_t *data, size_t length);
+void processWsOutboxes();
+
+#endif
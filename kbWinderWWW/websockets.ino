@@ -44,7 +44,49 @@ void handleStatusBroadcasts() {
   }
 }
 
-void broadcastLog(LogLevel level, const String &message) {
+/**
+ * @brief Outbox of a client, created on first use.
+ * Outboxes of gone clients are removed by processWsOutboxes().
+ */
+WsOutbox &getWsOutbox(uint32_t clientId) {
+  for (auto &box : wsOutboxes) {
+    if (box.clientId == clientId)
+      return box;
+  }
+  wsOutboxes.push_back({clientId, false, false, {}, {}});
+  return wsOutboxes.back();
+}
+
+bool isCriticalLog(LogLevel level, const char *message) {
+  if (level == LOG_LEVEL_ERROR || level == LOG_LEVEL_ALWAYS)
+    return true;
+  return level == LOG_LEVEL_NANO && (strncmp(message, "ERROR", 5) == 0 || strncmp(message, "ALARM", 5) == 0);
+}
+
+/**
+ * @brief Queues a log line for one client.
+ * If the queue is full, the oldest of the most verbose non-critical lines
+ * makes room. Critical lines are queued even past the soft limit.
+ */
+void queueWsLog(WsOutbox &box, LogLevel level, bool critical, const String &json) {
+  if (box.logs.size() >= WS_OUTBOX_LOG_LINES) {
+    auto victim = box.logs.end();
+    for (auto it = box.logs.begin(); it != box.logs.end(); ++it) {
+      if (!it->critical && (victim == box.logs.end() || it->level > victim->level))
+        victim = it;
+    }
+    if (victim != box.logs.end()) {
+      box.logs.erase(victim);
+      wsDroppedMessages++;
+    } else if (!critical) {
+      wsDroppedMessages++;
+      return; // only critical lines queued, the new one goes
+    }
+  }
+  box.logs.push_back({level, critical, json});
+}
+
+void broadcastLog(LogLevel level, const char *message) {
   if (ws == nullptr || ws->count() == 0)
     return;
 
@@ -53,32 +95,73 @@ void broadcastLog(LogLevel level, const String &message) {
   doc[F("level")] = getLogLevelName(level); // Zwraca __FlashStringHelper*
   doc[F("message")] = message;
 
-  static char buffer[MAX_LOG_LINE_LENGTH + 512];
+  String json;
+  serializeJson(doc, json);
 
-  size_t len = serializeJson(doc, buffer, sizeof(buffer));
+  // Nie czekamy na klientów - każdy dostaje linię do swojej kolejki
+  bool critical = isCriticalLog(level, message);
+  for (auto const &client : ws->getClients()) {
+    if (client->status() == WS_CONNECTED)
+      queueWsLog(getWsOutbox(client->id()), level, critical, json);
+  }
+}
 
-  // zamiast tego:
-  // ws->textAll(buffer, len);
-  // to co poniżej:
-  //  Iterujemy ręcznie po klientach zamiast używać ślepego textAll
+/**
+ * @brief Queues a binary message (live samples) for every client.
+ */
+void broadcastBinary(const uint8_t *data, size_t length) {
+  if (ws == nullptr)
+    return;
   for (auto const &client : ws->getClients()) {
-    if (client->status() == WS_CONNECTED) {
+    if (client->status() != WS_CONNECTED)
+      continue;
+    WsOutbox &box = getWsOutbox(client->id());
+    if (box.samples.size() >= WS_OUTBOX_SAMPLES) {
+      box.samples.pop_front();
+      wsDroppedMessages++;
+    }
+    box.samples.emplace_back(data, data + length);
+  }
+}
 
-      // TO JEST KLUCZ: Czekamy, aż konkretny klient będzie mógł przyjąć dane
-      unsigned long startWait = millis();
-      while (!client->canSend()) {
-        yield(); // Pozwól ESP obsłużyć WiFi w tle
+/**
+ * @brief Sends whatever each client can take right now, without waiting.
+ * Called from loop(); drops outboxes of disconnected clients and closes
+ * clients that fell behind even on critical lines.
+ */
+void processWsOutboxes() {
+  if (ws == nullptr)
+    return;
 
-        // Safety timeout - jeśli klient "zamarzł", nie blokuj maszyny na wieki
-        if (millis() - startWait > 150) {
-          // Serial.println("WS: Client buffer timeout - dropping frame");
-          break;
-        }
+  for (auto box = wsOutboxes.begin(); box != wsOutboxes.end();) {
+    AsyncWebSocketClient *client = ws->client(box->clientId);
+    if (client == nullptr || client->status() == WS_DISCONNECTED) {
+      box = wsOutboxes.erase(box);
+      continue;
+    }
+    if (client->status() == WS_CONNECTED) {
+      if (box->logs.size() > WS_OUTBOX_HARD_LIMIT) {
+        logMessagef(LOG_LEVEL_WARNING, "WebSocket: Client #%u too slow, closing", box->clientId);
+        client->close();
+        box = wsOutboxes.erase(box);
+        continue;
+      }
+      if (box->statusPending && client->canSend()) {
+        uint8_t kind = box->statusFull ? 1 : 0;
+        client->text(statusCache.json[kind], statusCache.length[kind]);
+        box->statusPending = false;
+        box->statusFull = false;
+      }
+      while (!box->samples.empty() && client->canSend()) {
+        client->binary(box->samples.front().data(), box->samples.front().size());
+        box->samples.pop_front();
+      }
+      while (!box->logs.empty() && client->canSend()) {
+        client->text(box->logs.front().json);
+        box->logs.pop_front();
       }
-
-      // Wysyłamy tylko do tego klienta, wiedząc że ma miejsce w kolejce
-      client->text(buffer, len);
     }
+    ++box;
   }
 }
 
@@ -93,9 +176,13 @@ void fillSystemStatus(JsonObject &root, bool full) {
   root[F("uptime")] = millis() / 1000;
   root[F("wifiRSSI")] = WiFi.RSSI();
   root[F("webDebugEnabled")] = configuration.system.webDebugEnabled;
+  fillNanoTelemetry(root);
+  fillWinderState(root, full);
 
   if (configuration.system.webDebugEnabled) {
     root[F("heapFragmentation")] = ESP.getHeapFragmentation();
+    root[F("nanoLineOverflows")] = nanoLineOverflows;
+    root[F("wsDroppedMessages")] = wsDroppedMessages;
     root[F("sketchSize")] = ESP.getSketchSize();
     root[F("cpuFreqMHz")] = ESP.getCpuFreqMHz();
     full = true;
@@ -155,6 +242,41 @@ void fillSystemStatus(JsonObject &root, bool full) {
   }
 }
 
+/**
+ * @brief Rebuilds the minimal or full status JSON in the static arena and buffer.
+ */
+void buildStatusJson(bool full) {
+  uint8_t kind = full ? 1 : 0;
+  statusArena.clear();
+  JsonObject root = statusArena.to<JsonObject>();
+  fillSystemStatus(root, full);
+
+  size_t length;
+  if (!statusArena.overflowed() && measureJson(statusArena) < statusCache.size[kind]) {
+    length = serializeJsonSmart(statusArena, statusCache.json[kind], statusCache.size[kind]);
+  } else {
+    // Nie wysyłamy uciętego JSON-a - krótki status z flagą zamiast tego
+    logMessagef(LOG_LEVEL_WARNING, "Status JSON too large (%u bytes), sending a short one", (unsigned)measureJson(statusArena));
+    statusArena.clear();
+    JsonObject root = statusArena.to<JsonObject>();
+    root[F("type")] = "status";
+    root[F("truncated")] = true;
+    root[F("uptime")] = millis() / 1000;
+    length = serializeJson(statusArena, statusCache.json[kind], statusCache.size[kind]);
+  }
+  statusCache.length[kind] = length;
+  statusCache.builtAt[kind] = millis();
+}
+
+/**
+ * @brief Marks a status as pending for one client.
+ * A full status still waiting is not downgraded to a minimal one.
+ */
+void queueWsStatus(WsOutbox &box, bool full) {
+  box.statusFull = full || (box.statusPending && box.statusFull);
+  box.statusPending = true;
+}
+
 /**
  * @brief Wysyła status do HTTP, konkretnego klienta WS lub wszystkich przez WS.
  * @param request Jeśli podany, wyśle odpowiedź HTTP.
@@ -170,31 +292,33 @@ void sendUnifiedStatus(
   // 3. Jeśli mamy flagę pendingIpNotify -> FULL
   // 4. Jeśli wymuszono (forceFull) -> FULL
   bool sendFull = (request != nullptr) || (client != nullptr) || pendingIpNotify || forceFull;
+  uint8_t kind = sendFull ? 1 : 0;
 
-  DynamicJsonDocument doc(sendFull ? 4096 : 1024);
-  JsonObject root = doc.to<JsonObject>();
-
-  fillSystemStatus(root, sendFull);
-
-  String output;
-  serializeJsonSmart(doc, output);
+  // Broadcast = coś się zmieniło (albo minęła sekunda) - budujemy od nowa.
+  // HTTP i nowi klienci dostają świeży bufor bez budowania.
+  if (broadcast || statusCache.length[kind] == 0 || millis() - statusCache.builtAt[kind] >= STATUS_CACHE_MS)
+    buildStatusJson(sendFull);
 
   // 1. Odpowiedź na żądanie HTTP
   if (request != nullptr) {
-    request->send(200, FPSTR(APPLICATION_JSON), output);
+    request->send(200, FPSTR(APPLICATION_JSON), statusCache.json[kind]);
   }
 
-  // 2. Wysyłka do konkretnego klienta WebSocket
+  // 2. Wysyłka do konkretnego klienta WebSocket (przez jego kolejkę)
   if (client != nullptr) {
-    client->text(output);
+    queueWsStatus(getWsOutbox(client->id()), sendFull);
   }
 
-  // 3. Rozgłoszenie do wszystkich (broadcast)
+  // 3. Rozgłoszenie do wszystkich (broadcast) - starszy, niewysłany status
+  // jest po prostu zastępowany najnowszym z bufora
   if (broadcast && ws != nullptr) {
-    ws->textAll(output);
+    for (auto const &c : ws->getClients()) {
+      if (c->status() == WS_CONNECTED)
+        queueWsStatus(getWsOutbox(c->id()), sendFull);
+    }
     // SKASOWANIE FLAGI dopiero tutaj - po rozesłaniu do wszystkich
     if (sendFull && pendingIpNotify) {
       pendingIpNotify = false;
     }
   }
-}
\ No newline at end of file
+}
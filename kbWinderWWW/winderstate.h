@@ -0,0 +1,63 @@
+/**
+ * @file winderstate.h
+ * @brief Machine state cache built from the Nano's console output.
+ *
+ * Every line the Nano prints goes through parseNanoLine(), which picks up
+ * the STATUS dump, progress and layer flip messages, task start/end,
+ * alarms and GET dumps. /api/status and new WebSocket clients are answered
+ * from this cache, so polling does not add any UART traffic. Every field
+ * group keeps the millis() of its last update, reported as an age.
+ */
+
+#ifndef WINDERSTATE_H
+#define WINDERSTATE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <map>
+
+#define WINDER_STATE_NAME_LEN 8 ///< "WINDING" + NUL
+
+// Bounds of the GET dump cache, so the full status JSON has a known maximum
+// size (the Nano has 33 labels, the longest 22 characters)
+#define WINDER_SETTINGS_MAX 40
+#define WINDER_SETTING_KEY_LEN 24   ///< Longer keys are ignored
+#define WINDER_SETTING_VALUE_LEN 16 ///< Longer values are cut
+
+struct WinderState {
+  unsigned long updatedAt = 0; ///< Last line parsed, 0 = nothing yet
+
+  char state[WINDER_STATE_NAME_LEN] = "";
+  uint8_t queued = 0;
+  unsigned long stateAt = 0;
+
+  float progress = 0; ///< % of the current task
+  float rpm = 0;
+  unsigned long progressAt = 0;
+
+  float absPosMM = 0;
+  unsigned long positionAt = 0;
+
+  float turns = 0; ///< From "Progress" / "Layer Flip" messages
+  long totalTurns = 0;
+  uint16_t layerFlips = 0; ///< Since the last task start
+  unsigned long turnsAt = 0;
+
+  bool homed = false;
+  bool homing = false; ///< Homing queued or running, until it ends
+  unsigned long taskStartedAt = 0;
+  unsigned long taskCompletedAt = 0;
+
+  String lastAlarm; ///< Last ERROR: / ALARM: line
+  unsigned long alarmAt = 0;
+
+  std::map<String, String> settings; ///< "[MACHINE] LABEL: value" from GET, bounded
+  unsigned long settingsAt = 0;
+};
+
+WinderState winderState;
+
+void parseNanoLine(const char *line);
+void fillWinderState(JsonObject &root, bool full);
+
+#endif
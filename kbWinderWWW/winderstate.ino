@@ -0,0 +1,211 @@
+/**
+ * @file winderstate.ino
+ * @brief Parses Nano console lines into winderState.
+ */
+
+#include "winderstate.h"
+
+static bool lineStartsWith(const char *line, const char *prefix) { return strncmp(line, prefix, strlen(prefix)) == 0; }
+
+static void setWinderState(const char *name, uint8_t queued) {
+  WinderState &w = winderState;
+  if (strcmp(w.state, name) != 0 || w.queued != queued)
+    updateWsStatusPending = true; // zmiana stanu idzie do UI od razu
+  strlcpy(w.state, name, sizeof(w.state));
+  w.queued = queued;
+  w.stateAt = millis();
+  if (strcmp(name, "IDLE") == 0) {
+    w.homing = false;  // STOP czyści kolejkę razem z bazowaniem
+    runRecorderStop(); // koniec przebiegu (o ile trwał)
+  }
+}
+
+static void setHomed(bool homed) {
+  WinderState &w = winderState;
+  if (w.homed != homed)
+    updateWsStatusPending = true;
+  w.homed = homed;
+}
+
+/**
+ * @brief "MSG: Progress (12.0 turns / 200)" and "MSG: Layer Flip (...)".
+ */
+static void parseTurns(const char *args) {
+  WinderState &w = winderState;
+  const char *open = strchr(args, '(');
+  const char *slash = strchr(args, '/');
+  if (open == nullptr || slash == nullptr)
+    return;
+  w.turns = atof(open + 1);
+  w.totalTurns = atol(slash + 1);
+  w.turnsAt = millis();
+}
+
+/**
+ * @brief "[MACHINE] SCREW PITCH: 1.000" from GET / GET MACHINE etc.
+ */
+static void parseSetting(const char *line) {
+  const char *label = strchr(line, ']');
+  const char *colon = strstr(line, ": ");
+  if (label == nullptr || colon == nullptr || colon < label)
+    return;
+  label++;
+  while (*label == ' ')
+    label++;
+
+  if (colon <= label || colon - label > WINDER_SETTING_KEY_LEN)
+    return;
+  String key(label);
+  key.remove(colon - label);
+  auto &settings = winderState.settings;
+  if (settings.size() >= WINDER_SETTINGS_MAX && settings.find(key) == settings.end())
+    return; // śmieci z linii nie mogą rozdmuchać statusu
+  String value(colon + 2);
+  if (value.length() > WINDER_SETTING_VALUE_LEN)
+    value.remove(WINDER_SETTING_VALUE_LEN);
+  settings[key] = value;
+  winderState.settingsAt = millis();
+  if (key == "IS HOMED")
+    setHomed(strcmp(colon + 2, "ON") == 0);
+}
+
+/**
+ * @brief Updates the cache from one (trimmed) line of Nano output.
+ * Lines it does not know are ignored.
+ */
+void parseNanoLine(const char *line) {
+  WinderState &w = winderState;
+  unsigned long now = millis();
+
+  // --- Boot banner: the Nano was reset and lost its zero ---
+  if (lineStartsWith(line, "--- kbWinder OS")) {
+    w.homing = false;
+    setHomed(false);
+  }
+
+  // --- STATUS dump (also printed after every stop and task end) ---
+  else if (lineStartsWith(line, "State: ")) {
+    setWinderState(line + 7, 0);
+    w.progress = 0;
+    w.rpm = 0;
+    w.progressAt = now;
+  } else if (lineStartsWith(line, "Current Task: ")) {
+    char name[WINDER_STATE_NAME_LEN];
+    const char *p = line + 14;
+    uint8_t n = 0;
+    while (*p != 0 && *p != ' ' && n < sizeof(name) - 1)
+      name[n++] = *p++;
+    name[n] = 0;
+    const char *open = strchr(p, '(');
+    setWinderState(name, open != nullptr ? atoi(open + 1) : 0);
+  } else if (lineStartsWith(line, "Progress: ")) {
+    w.progress = atof(line + 10);
+    w.progressAt = now;
+  } else if (lineStartsWith(line, "Current RPM: ")) {
+    w.rpm = atof(line + 13);
+    w.progressAt = now;
+  } else if (lineStartsWith(line, "Abs Position: ")) {
+    w.absPosMM = atof(line + 14);
+    w.positionAt = now;
+  }
+
+  // --- Messages ---
+  else if (lineStartsWith(line, "MSG: Progress ")) {
+    parseTurns(line);
+  } else if (lineStartsWith(line, "MSG: Layer Flip ")) {
+    parseTurns(line);
+    w.layerFlips++;
+    updateWsStatusPending = true;
+    runRecorderEvent(RUN_EV_LAYER_FLIP);
+  } else if (lineStartsWith(line, "MSG: Winding sequence enqueued")) {
+    runRecorderStart();
+  } else if (lineStartsWith(line, "Task started")) {
+    w.taskStartedAt = now;
+    w.layerFlips = 0;
+    w.turns = 0;
+  } else if (lineStartsWith(line, "MSG: Task complete")) {
+    w.taskCompletedAt = now;
+    runRecorderEvent(RUN_EV_TASK_DONE);
+  } else if (lineStartsWith(line, "MSG: Homing added to queue")) {
+    w.homing = true;
+    setHomed(false); // Nano kasuje isHomed przy każdym bazowaniu
+  } else if (lineStartsWith(line, "MSG: Homing finished") || lineStartsWith(line, "MSG: Precision Home reached") ||
+             lineStartsWith(line, "MSG: Machine absolute ZERO")) {
+    w.homing = false;
+    setHomed(true);
+  } else if (lineStartsWith(line, "MSG: Status set to PAUSED")) {
+    setWinderState("PAUSE", w.queued);
+    runRecorderEvent(RUN_EV_PAUSE);
+  } else if (lineStartsWith(line, "MSG: Task resumed")) {
+    runRecorderEvent(RUN_EV_RESUME);
+  } else if (lineStartsWith(line, "ERROR") || lineStartsWith(line, "ALARM")) {
+    w.lastAlarm = line;
+    w.alarmAt = now;
+    updateWsStatusPending = true;
+    if (w.homing) { // bazowanie przerwane - zero nieznane
+      w.homing = false;
+      setHomed(false);
+    }
+    runRecorderEvent(RUN_EV_ALARM);
+  }
+
+  // --- GET dumps ---
+  else if (line[0] == '[') {
+    parseSetting(line);
+  } else {
+    return;
+  }
+  w.updatedAt = now;
+}
+
+static void addAge(JsonObject &obj, const __FlashStringHelper *key, unsigned long at) {
+  if (at != 0)
+    obj[key] = millis() - at;
+}
+
+/**
+ * @brief Adds the cached machine state to a status JSON as "winder".
+ * Ages are in ms; settings from GET dumps only go into full status.
+ */
+void fillWinderState(JsonObject &root, bool full) {
+  const WinderState &w = winderState;
+  if (w.updatedAt == 0)
+    return;
+
+  JsonObject winder = root.createNestedObject(F("winder"));
+  winder[F("age")] = millis() - w.updatedAt;
+  if (w.stateAt != 0) {
+    winder[F("state")] = w.state;
+    winder[F("queued")] = w.queued;
+    addAge(winder, F("stateAge"), w.stateAt);
+  }
+  if (w.progressAt != 0) {
+    winder[F("progress")] = w.progress;
+    winder[F("rpm")] = w.rpm;
+    addAge(winder, F("progressAge"), w.progressAt);
+  }
+  if (w.positionAt != 0) {
+    winder[F("absPosMM")] = w.absPosMM;
+    addAge(winder, F("positionAge"), w.positionAt);
+  }
+  if (w.turnsAt != 0) {
+    winder[F("turns")] = w.turns;
+    winder[F("totalTurns")] = w.totalTurns;
+    winder[F("layerFlips")] = w.layerFlips;
+    addAge(winder, F("turnsAge"), w.turnsAt);
+  }
+  winder[F("homed")] = w.homed;
+  addAge(winder, F("taskStartedAge"), w.taskStartedAt);
+  addAge(winder, F("taskCompletedAge"), w.taskCompletedAt);
+  if (w.alarmAt != 0) {
+    winder[F("lastAlarm")] = w.lastAlarm.c_str();
+    addAge(winder, F("alarmAge"), w.alarmAt);
+  }
+
+  if (full && w.settingsAt != 0) {
+    JsonObject settings = winder.createNestedObject(F("settings"));
+    for (auto const &entry : w.settings)
+      settings[entry.first.c_str()] = entry.second.c_str();
+    addAge(winder, F("settingsAge"), w.settingsAt);
+  }
+}
@@ -0,0 +1,30 @@
+#ifndef PERF_H
+#define PERF_H
+
+// --- MOTION CORE INSTRUMENTATION ---
+// Cheap counters kept by the step ISR and loop(), reported by GET PERF and
+// cleared by RESET PERF. Times in the ISR are Timer1 ticks (0.5 us).
+
+// Step timing error histogram: how late each step ISR started after its
+// compare match. Bucket n counts errors below 2^n us (<1, <2, <4 ... 64+).
+#define PERF_BUCKETS 8
+
+volatile uint16_t perfErrorHistogram[PERF_BUCKETS];
+volatile uint32_t perfSteps = 0;
+volatile uint16_t perfLateSteps = 0;      // error above 1/8 of the period
+volatile uint16_t perfWorstLatency = 0;   // ticks
+volatile uint16_t perfFastestPeriod = 0xFFFF; // ticks, shortest OCR1A used
+
+unsigned long perfLastLoopMicros = 0;
+unsigned long perfWorstLoop = 0;          // us between two loop() passes
+unsigned long perfCommandCount = 0;
+unsigned long perfCommandTotal = 0;       // us spent in processCommand()
+unsigned long perfWorstCommand = 0;       // us
+
+void perfRecordStep(uint16_t latency, uint16_t period);
+void perfTrackLoop();
+void perfTrackCommand(unsigned long started);
+void perfReset();
+void printPerf();
+
+#endif // PERF_H
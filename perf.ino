@@ -0,0 +1,112 @@
+#include "perf.h"
+
+// --- COUNTERS ---
+
+// Called from the step ISR with TCNT1 read on entry (= ticks since the
+// compare match) and the period that was scheduled for this step.
+void perfRecordStep(uint16_t latency, uint16_t period) {
+  uint8_t bucket = 0;
+  for (uint16_t us = latency >> 1; us != 0 && bucket < PERF_BUCKETS - 1; us >>= 1)
+    bucket++;
+  if (perfErrorHistogram[bucket] != 0xFFFF)
+    perfErrorHistogram[bucket]++;
+
+  if (latency > (period >> 3) && perfLateSteps != 0xFFFF)
+    perfLateSteps++;
+  if (latency > perfWorstLatency)
+    perfWorstLatency = latency;
+  if (period < perfFastestPeriod)
+    perfFastestPeriod = period;
+  perfSteps++;
+}
+
+void perfTrackLoop() {
+  unsigned long now = micros();
+  if (perfLastLoopMicros != 0 && now - perfLastLoopMicros > perfWorstLoop)
+    perfWorstLoop = now - perfLastLoopMicros;
+  perfLastLoopMicros = now;
+}
+
+void perfTrackCommand(unsigned long started) {
+  unsigned long took = micros() - started;
+  perfCommandCount++;
+  perfCommandTotal += took;
+  if (took > perfWorstCommand)
+    perfWorstCommand = took;
+}
+
+void perfReset() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t i = 0; i < PERF_BUCKETS; i++)
+      perfErrorHistogram[i] = 0;
+    perfSteps = 0;
+    perfLateSteps = 0;
+    perfWorstLatency = 0;
+    perfFastestPeriod = 0xFFFF;
+  }
+  perfLastLoopMicros = 0;
+  perfWorstLoop = 0;
+  perfCommandCount = 0;
+  perfCommandTotal = 0;
+  perfWorstCommand = 0;
+}
+
+// --- REPORT ---
+
+void printPerf() {
+  uint16_t histogram[PERF_BUCKETS];
+  uint32_t steps;
+  uint16_t late, worstLatency, fastest;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t i = 0; i < PERF_BUCKETS; i++)
+      histogram[i] = perfErrorHistogram[i];
+    steps = perfSteps;
+    late = perfLateSteps;
+    worstLatency = perfWorstLatency;
+    fastest = perfFastestPeriod;
+  }
+
+  Serial.println(F("--- PERF ---"));
+  Serial.print(F("Steps: "));
+  Serial.print(steps);
+  Serial.print(F(", late: "));
+  Serial.println(late);
+
+  Serial.print(F("Step error (us):"));
+  for (uint8_t i = 0; i < PERF_BUCKETS; i++) {
+    Serial.print(i < PERF_BUCKETS - 1 ? F(" <") : F(" "));
+    Serial.print(1 << (i < PERF_BUCKETS - 1 ? i : i - 1));
+    Serial.print(i < PERF_BUCKETS - 1 ? F(": ") : F("+: "));
+    Serial.print(histogram[i]);
+  }
+  Serial.println();
+
+  Serial.print(F("Worst step error: "));
+  Serial.print(worstLatency / STEPPER_TICKS_PER_US);
+  Serial.println(F(" us"));
+
+  Serial.print(F("Fastest step period: "));
+  if (fastest == 0xFFFF) {
+    Serial.println(F("-"));
+  } else {
+    // OCR1A holds period - 1
+    unsigned long periodUs = ((unsigned long)fastest + 1) / STEPPER_TICKS_PER_US;
+    Serial.print(periodUs);
+    Serial.print(F(" us ("));
+    Serial.print(1000000UL / periodUs);
+    Serial.println(F(" steps/s)"));
+  }
+
+  Serial.print(F("Worst loop: "));
+  Serial.print(perfWorstLoop);
+  Serial.println(F(" us"));
+
+  Serial.print(F("Commands: "));
+  Serial.print(perfCommandCount);
+  Serial.print(F(", worst: "));
+  Serial.print(perfWorstCommand);
+  Serial.print(F(" us, total: "));
+  Serial.print(perfCommandTotal / 1000);
+  Serial.println(F(" ms"));
+  Serial.println(F("------------"));
+}
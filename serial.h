@@ -1,7 +1,36 @@
 #ifndef SERIAL_H
 #define SERIAL_H
 
-void processCommand(String cmd);
+// --- LINE ASSEMBLER ---
+// Bytes are collected into a fixed buffer a few at a time from loop(), so a
+// partial line never blocks the motion core and nothing touches the heap.
+#define CMD_BUFFER_SIZE 80      // longest line: SAVE <csv>
+#define SERIAL_BYTES_PER_LOOP 8 // max bytes consumed per loop() iteration
+
+// A line may be tagged "#<seq> <command>"; it is then answered with
+// "ACK <seq>" after the command has run. The ESP uses the acks as credits
+// for the 64 byte RX buffer instead of pacing commands by time.
+
+char cmdBuffer[CMD_BUFFER_SIZE];
+uint8_t cmdLength = 0;
+bool cmdOverflow = false;
+
+// --- DISPATCH TABLE ---
+// Commands are matched in table order as whole words ("JOG PING" before
+// "JOG"); the handler gets the trimmed rest of the line. An exact entry
+// only matches when nothing follows, so "SET HOME BEFORE START ON" falls
+// through to "SET".
+typedef void (*CommandHandler)(char *args);
+
+struct CommandEntry {
+  char name[11];
+  CommandHandler handler;
+  bool exact;
+};
+
+void pollSerial();
+void processCommand(char *cmd);
+char *nextToken(char **cursor);
 void printHelp();
 void printLongHelp();
 void printSetHelp();
@@ -1,73 +1,179 @@
 
+// --- LINE ASSEMBLER ---
+
+void pollSerial() {
+  for (uint8_t n = 0; n < SERIAL_BYTES_PER_LOOP && Serial.available(); n++) {
+    char c = Serial.read();
+    if (c == '\r')
+      continue;
+    if (c != '\n') {
+      if (cmdLength < CMD_BUFFER_SIZE - 1)
+        cmdBuffer[cmdLength++] = c;
+      else
+        cmdOverflow = true;
+      continue;
+    }
+
+    cmdBuffer[cmdLength] = 0;
+    // "#<seq> <command>" comes from the ESP queue and is acked when done
+    char *cmd = cmdBuffer;
+    int ackSeq = -1;
+    if (*cmd == '#')
+      ackSeq = (int)strtol(cmd + 1, &cmd, 10);
+
+    if (cmdOverflow) {
+      Serial.println(F("ERROR: Command too long, ignored."));
+    } else {
+      unsigned long started = micros();
+      processCommand(cmd);
+      perfTrackCommand(started);
+    }
+    if (ackSeq >= 0) {
+      Serial.print(F("ACK "));
+      Serial.println(ackSeq);
+    }
+    cmdLength = 0;
+    cmdOverflow = false;
+    return; // one command per loop, let executeMotion() run
+  }
+}
+
+// Returns the next space separated token (terminated in place) and moves
+// the cursor past it, or NULL at the end of the line.
+char *nextToken(char **cursor) {
+  char *p = *cursor;
+  while (*p == ' ')
+    p++;
+  if (*p == 0) {
+    *cursor = p;
+    return NULL;
+  }
+  char *token = p;
+  while (*p != 0 && *p != ' ')
+    p++;
+  if (*p != 0)
+    *p++ = 0;
+  *cursor = p;
+  return token;
+}
+
+// --- COMMAND HANDLERS ---
+
+void cmdStop(char *args) { emergencyStop(true); }
+
+void cmdJogPing(char *args) {
+  jogLastPinged = millis();
+}
+
+void cmdStatus(char *args) { printStatus(); }
+void cmdPause(char *args) { pauseTask(); }
+void cmdResume(char *args) { resumeTask(); }
+
+void cmdSetZero(char *args) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { absPos = 0; }
+  isHomed = true;
+  Serial.println(F("MSG: Machine absolute ZERO established at current position"));
+}
+
+void cmdSetHome(char *args) {
+  // HOME w naszym nazewnictwie to startOffset w strukturze presetu
+  long pos = stepperReadPosition();
+  active.startOffset = pos;
+
+  Serial.print(F("MSG: Preset START OFFSET set to "));
+  Serial.print((float)pos / stepsPerMM, 3);
+  Serial.println(F(" mm (Remember to SAVE if you want to keep it!)"));
+}
+
+void cmdSetBegin(char *args) { configBegin(); }
+void cmdSetCommit(char *args) { configCommit(); }
+
+void cmdGet(char *args) { handleGet(args); }
+void cmdGetTask(char *args) { printTaskDebug(getCurrentTask()); }
+void cmdGetMemory(char *args) { printFreeMemory(); }
+void cmdGetPerf(char *args) { printPerf(); }
+
+void cmdResetPerf(char *args) {
+  perfReset();
+  Serial.println(F("MSG: Performance counters cleared."));
+}
+void cmdSave(char *args) { savePreset(args); }
+void cmdLoad(char *args) { loadPresetByName(args); }
+void cmdDelete(char *args) { deletePreset(args); }
+void cmdFormat(char *args) { formatPresets(); }
+void cmdExport(char *args) { exportCSV(); }
+void cmdHelp(char *args) { printHelp(); }
+void cmdLongHelp(char *args) { printLongHelp(); }
+void cmdSetHelp(char *args) { printSetHelp(); }
+void cmdFactory(char *args) { loadFallbackConfiguration(); }
+
+void cmdJog(char *args) {
+  // JOG W|T <distance> [speed]
+  char *motor = nextToken(&args);
+  if (motor != NULL)
+    moveManual(motor[0], args, true);
+}
+
+void cmdMoveW(char *args) { moveManual('W', args, false); }
+void cmdMoveT(char *args) { moveManual('T', args, false); }
+
+const CommandEntry commandTable[] PROGMEM = {
+    {"STOP", cmdStop},
+    {"JOG PING", cmdJogPing},
+    {"STATUS", cmdStatus},
+    {"PAUSE", cmdPause},
+    {"START", parseStartCommand},
+    {"RESUME", cmdResume},
+    {"GOTO", handleGotoCommand},
+    {"SEEK ZERO", parseSeekZeroCommand},
+    {"SET ZERO", cmdSetZero, true},
+    {"SET HOME", cmdSetHome, true},
+    {"SET BEGIN", cmdSetBegin, true},
+    {"SET COMMIT", cmdSetCommit, true},
+    {"SET", handleSet},
+    {"GET TASK", cmdGetTask},
+    {"GET MEMORY", cmdGetMemory},
+    {"GET PERF", cmdGetPerf},
+    {"RESET PERF", cmdResetPerf},
+    {"GET", cmdGet},
+    {"TELEMETRY", handleTelemetryCommand},
+    {"SAVE", cmdSave},
+    {"LOAD", cmdLoad},
+    {"DELETE", cmdDelete},
+    {"FORMAT", cmdFormat},
+    {"EXPORT", cmdExport},
+    {"HELP", cmdHelp},
+    {"LONGHELP", cmdLongHelp},
+    {"SETHELP", cmdSetHelp},
+    {"FACTORY", cmdFactory},
+    {"JOG", cmdJog},
+    {"T", cmdMoveT},
+    {"W", cmdMoveW},
+    // (... handle more commands...)
+};
+
 // --- COMMAND INTERPRETER ---
 
-void processCommand(String cmd) {
-  cmd.trim();
-  cmd.toUpperCase();  // so presets will be case-insensitive ;)
-  Serial.println("Received: " + cmd);
-
-  if (cmd.startsWith(F("STOP"))) {
-    emergencyStop(true);
-  } else if (cmd.startsWith(F("JOG PING"))) {
-    getCurrentTask()->taskLastPinged = millis();
-    // Serial.print("RPM=");
-    // Serial.println(getCurrentTask()->currentRPM);
-  } else if (cmd.startsWith(F("STATUS"))) {
-    printStatus();
-  } else if (cmd.startsWith(F("PAUSE"))) {
-    pauseTask();
-  } else if (cmd.startsWith(F("START"))) {
-    parseStartCommand(cmd.substring(6));
-  } else if (cmd.startsWith(F("RESUME"))) {
-    resumeTask();
-  } else if (cmd.startsWith(F("GOTO "))) {
-    handleGotoCommand(cmd);
-  } else if (cmd.startsWith(F("SEEK ZERO"))) {
-    parseSeekZeroCommand(cmd);
-  } else if (cmd == F("SET ZERO")) {
-    absPos = 0;
-    isHomed = true;
-    Serial.println(
-      F("MSG: Machine absolute ZERO established at current position"));
-  } else if (cmd == F("SET HOME")) {
-    // HOME w naszym nazewnictwie to startOffset w strukturze presetu
-    active.startOffset = absPos;
-
-    Serial.print(F("MSG: Preset START OFFSET set to "));
-    Serial.print((float)absPos / stepsPerMM, 3);
-    Serial.println(F(" mm (Remember to SAVE if you want to keep it!)"));
-  } else if (cmd.startsWith(F("SET "))) {
-    handleSet(cmd.substring(4));
-  } else if (cmd.startsWith(F("GET TASK"))) {
-    printTaskDebug(getCurrentTask());
-  } else if (cmd.startsWith(F("GET MEMORY"))) {
-    printFreeMemory();
-  } else if (cmd.startsWith(F("GET"))) {
-    handleGet(cmd.substring(3));
-  } else if (cmd.startsWith(F("SAVE"))) {
-    savePreset(cmd.substring(4));
-  } else if (cmd.startsWith(F("LOAD "))) {
-    loadPresetByName(cmd.substring(5));
-  } else if (cmd.startsWith(F("DELETE "))) {
-    deletePreset(cmd.substring(7));
-  } else if (cmd.startsWith(F("FORMAT"))) {
-    formatPresets();
-  } else if (cmd.startsWith(F("EXPORT"))) {
-    exportCSV();
-  } else if (cmd.startsWith(F("HELP"))) {
-    printHelp();
-  } else if (cmd.startsWith(F("LONGHELP"))) {
-    printLongHelp();
-  } else if (cmd.startsWith(F("SETHELP"))) {
-    printSetHelp();
-  } else if (cmd.startsWith(F("FACTORY"))) {
-    loadFallbackConfiguration();
-
-  } else if (cmd.startsWith(F("JOG "))) {
-    moveManual(cmd.substring(4), true);
-  }  // (... handle more commands...)
-  else if (cmd.startsWith("T ") || cmd.startsWith("W ")) {
-    moveManual(cmd);
+void processCommand(char *cmd) {
+  cmd = trimChar(cmd);
+  for (char *p = cmd; *p; p++)
+    *p = toupper(*p); // so presets will be case-insensitive ;)
+  Serial.print(F("Received: "));
+  Serial.println(cmd);
+
+  for (uint8_t i = 0; i < sizeof(commandTable) / sizeof(CommandEntry); i++) {
+    const CommandEntry *entry = &commandTable[i];
+    size_t len = strlen_P(entry->name);
+    if (strncmp_P(cmd, entry->name, len) != 0)
+      continue;
+    if (cmd[len] != 0 && cmd[len] != ' ')
+      continue; // "SETHELP" is not "SET"
+    if (cmd[len] != 0 && pgm_read_byte(&entry->exact))
+      continue;
+
+    CommandHandler handler = (CommandHandler)pgm_read_ptr(&entry->handler);
+    handler(trimChar(cmd + len));
+    return;
   }
 }
 
@@ -78,7 +184,7 @@ void printHelp() {
       "Control: START [values], STOP, PAUSE, RESUME\n"
       "Presets: SAVE [name], LOAD [name], DELETE [name], FORMAT, EXPORT\n"
       "Settings: GET [MACHINE|PRESET|RUNTIME|MEMORY|<val>], SET ..., FACTORY\n"
-      "Info: STATUS, HELP, LONGHELP, SETHELP"));
+      "Info: STATUS, GET PERF, RESET PERF, TELEMETRY, HELP, LONGHELP, SETHELP"));
 }
 
 void printLongHelp() {
@@ -106,9 +212,13 @@ void printLongHelp() {
       "FORMAT: deletes all presets\n"
       "EXPORT: prints presets in CSV format\n"
       "STATUS: prints status\n"
+      "GET PERF: step timing, loop and command timing counters\n"
+      "RESET PERF: clears the GET PERF counters\n"
+      "TELEMETRY [ON [ms]|OFF]: binary status frames for the WiFi module\n"
       "FACTORY: loads default machine settings\n"
       "SET ... : sets parameter(s)\n"
       "GET ... : gets parameter(s)\n"
+      "SET BEGIN / SET COMMIT: batch SETs into one EEPROM write\n"
       "SETHELP: parameters list\n"
       "HELP: short help\n"
       "LONGHELP: this help"));
@@ -152,7 +262,7 @@ void printStatus() {
 
     float progress = 0;
     if (t->targetSteps > 0) {
-      progress = (float)t->currentSteps / t->targetSteps * 100.0;
+      progress = (float)stepperReadSteps(t) / t->targetSteps * 100.0;
     } else if (t->isStarted) {
       // Jeśli zadanie się zaczęło i targetSteps to 0, to znaczy że jesteśmy u
       // celu
@@ -163,10 +273,10 @@ void printStatus() {
     Serial.print(progress, 1);
     Serial.println(F("%"));
     Serial.print(F("Current RPM: "));
-    Serial.println(t->currentRPM);
+    Serial.println(RPM_TO_FLOAT(t->currentRPM));
   }
   Serial.print(F("Abs Position: "));
-  Serial.print((float)absPos / stepsPerMM);
+  Serial.print((float)stepperReadPosition() / stepsPerMM);
   Serial.println(F(" mm"));
   Serial.println(F("----------------------"));
 
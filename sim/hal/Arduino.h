@@ -0,0 +1,117 @@
+/**
+ * Host-side stand-in for the Arduino AVR core, just enough to build the
+ * Nano firmware on Linux. Time is virtual and advanced by the simulator.
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <type_traits>
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+template <typename A, typename B> typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template <typename A, typename B> typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template <typename A, typename L, typename H> A constrain(A x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(PSTR(s)))
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n; i++)
+      write(buf[i]);
+    return n;
+  }
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) {
+    char b[24];
+    snprintf(b, sizeof(b), base == HEX ? "%lX" : "%ld", v);
+    return write(b);
+  }
+  size_t print(unsigned long v, int base = DEC) {
+    char b[24];
+    snprintf(b, sizeof(b), base == HEX ? "%lX" : "%lu", v);
+    return write(b);
+  }
+  size_t print(double v, int digits = 2) {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", digits, v);
+    return write(b);
+  }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+  template <typename T> size_t println(T v, int f) { return print(v, f) + println(); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  using Print::write;
+  int availableForWrite();
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,43 @@
+/**
+ * Host stand-in for the Arduino EEPROM library. The ATmega328P has 1 KB, but
+ * on the host int is 32-bit and long 64-bit, so the same structs (25 preset
+ * slots plus the directory) need more room.
+ */
+
+#ifndef SIM_EEPROM_H
+#define SIM_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+struct EEPROMClass {
+  static const int SIZE = 2048;
+  uint8_t data[SIZE];
+  unsigned long writes;
+
+  uint8_t read(int addr) { return data[addr]; }
+  void write(int addr, uint8_t v) {
+    data[addr] = v;
+    writes++;
+  }
+  void update(int addr, uint8_t v) {
+    if (data[addr] != v)
+      write(addr, v);
+  }
+  uint16_t length() { return SIZE; }
+
+  template <typename T> T &get(int addr, T &t) {
+    memcpy(&t, data + addr, sizeof(T));
+    return t;
+  }
+  template <typename T> const T &put(int addr, const T &t) {
+    const uint8_t *p = (const uint8_t *)&t;
+    for (unsigned i = 0; i < sizeof(T); i++)
+      update(addr + i, p[i]);
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // SIM_EEPROM_H
@@ -0,0 +1,8 @@
+/**
+ * Host stand-in for SoftwareSerial (unused by the firmware, but included).
+ */
+
+#ifndef SIM_SOFTWARESERIAL_H
+#define SIM_SOFTWARESERIAL_H
+
+#endif // SIM_SOFTWARESERIAL_H
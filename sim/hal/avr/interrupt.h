@@ -0,0 +1,17 @@
+/**
+ * Host stand-in for <avr/interrupt.h>. Interrupt handlers become plain
+ * functions which the simulator calls at the right virtual time.
+ */
+
+#ifndef SIM_INTERRUPT_H
+#define SIM_INTERRUPT_H
+
+#define ISR(vector) extern "C" void vector(void)
+
+void cli();
+void sei();
+
+#define noInterrupts() cli()
+#define interrupts() sei()
+
+#endif // SIM_INTERRUPT_H
@@ -0,0 +1,46 @@
+/**
+ * Host stand-in for <avr/io.h>: only the Timer1 registers used by the step
+ * engine. Writes are observed by the simulator, which plays the timer.
+ */
+
+#ifndef SIM_IO_H
+#define SIM_IO_H
+
+#include <stdint.h>
+
+#define _BV(bit) (1 << (bit))
+
+// TCCR1B
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+// TIMSK1
+#define OCIE1A 1
+// TIFR1
+#define OCF1A 1
+
+struct SimTimerReg {
+  uint16_t value;
+  void (*onWrite)(uint16_t);
+
+  SimTimerReg &operator=(uint16_t v) {
+    value = v;
+    if (onWrite)
+      onWrite(v);
+    return *this;
+  }
+  SimTimerReg &operator|=(uint16_t v) { return *this = value | v; }
+  SimTimerReg &operator&=(uint16_t v) { return *this = value & v; }
+  operator uint16_t() const { return value; }
+};
+
+extern SimTimerReg TCCR1A;
+extern SimTimerReg TCCR1B;
+extern SimTimerReg TCNT1;
+extern SimTimerReg OCR1A;
+extern SimTimerReg TIMSK1;
+extern SimTimerReg TIFR1;
+
+#endif // SIM_IO_H
@@ -0,0 +1,31 @@
+/**
+ * Host stand-in for <avr/pgmspace.h>: flash and RAM share one address space.
+ */
+
+#ifndef SIM_PGMSPACE_H
+#define SIM_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+#define strncasecmp_P strncasecmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strstr_P strstr
+
+#endif // SIM_PGMSPACE_H
@@ -0,0 +1,27 @@
+/**
+ * Host stand-in for <util/atomic.h>. The simulator never preempts the main
+ * loop, so the block only has to keep the interrupt flag bookkeeping right.
+ */
+
+#ifndef SIM_ATOMIC_H
+#define SIM_ATOMIC_H
+
+#include <avr/interrupt.h>
+
+bool simInterruptsEnabled();
+
+struct SimAtomicGuard {
+  bool wasEnabled;
+  int once;
+  SimAtomicGuard() : wasEnabled(simInterruptsEnabled()), once(1) { cli(); }
+  ~SimAtomicGuard() {
+    if (wasEnabled)
+      sei();
+  }
+};
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
+#define ATOMIC_BLOCK(type) for (SimAtomicGuard simGuard; simGuard.once; simGuard.once = 0)
+
+#endif // SIM_ATOMIC_H
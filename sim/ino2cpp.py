@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Turns an Arduino sketch folder into a single C++ translation unit.
+
+Mimics what the Arduino builder does before compiling: the main .ino goes
+first, the remaining .ino files follow in alphabetical order, and a
+prototype for every top-level function is inserted before the first
+function definition (so the sketch may call functions defined later on).
+"""
+
+import os
+import re
+import sys
+
+SIGNATURE = re.compile(
+    r"^(?P<ret>[\w:<>\*&\s]+?)\s*\b(?P<name>\w+)\s*\((?P<args>[^;{}]*)\)\s*(const\s*)?$",
+    re.S)
+NOT_FUNCTIONS = ("if", "for", "while", "switch", "return", "ISR", "sizeof")
+
+
+def strip(text):
+    """Blank out comments and string/char literals, keeping offsets intact."""
+    out = list(text)
+    i, n = 0, len(text)
+    while i < n:
+        c = text[i]
+        if text.startswith("//", i):
+            j = text.find("\n", i)
+            j = n if j < 0 else j
+            out[i:j] = " " * (j - i)
+            i = j
+        elif text.startswith("/*", i):
+            j = text.find("*/", i + 2)
+            j = n if j < 0 else j + 2
+            out[i:j] = re.sub(r"[^\n]", " ", text[i:j])
+            i = j
+        elif c in "\"'":
+            j = i + 1
+            while j < n and text[j] != c:
+                j += 2 if text[j] == "\\" else 1
+            out[i + 1:j] = " " * (j - i - 1)
+            i = j + 1
+        else:
+            i += 1
+    return "".join(out)
+
+
+def prototypes(text):
+    """Yields (offset, prototype) for every top-level function definition."""
+    clean = strip(text)
+    depth = 0
+    start = 0
+    for i, c in enumerate(clean):
+        if c == "{":
+            if depth == 0:
+                head = clean[start:i]
+                head = "\n".join(l for l in head.split("\n")
+                                 if not l.strip().startswith("#"))
+                head = head.strip()
+                m = SIGNATURE.match(head)
+                if m and m.group("name") not in NOT_FUNCTIONS:
+                    ret = m.group("ret").strip()
+                    # Like arduino-builder: no prototypes for class members
+                    # or for signatures with default arguments
+                    if (ret and not ret.endswith("::") and "=" not in m.group("args")
+                            and not re.search(r"\b(struct|class|enum|union|typedef|namespace)\b|=", ret)):
+                        yield start, " ".join(head.split()) + ";"
+            depth += 1
+        elif c == "}":
+            depth -= 1
+            if depth == 0:
+                start = i + 1
+        elif c == ";" and depth == 0:
+            start = i + 1
+        elif c == "\n" and depth == 0 and clean[start:i].strip().startswith("#"):
+            start = i + 1
+
+
+def main():
+    sketch_dir, main_ino, out = sys.argv[1], sys.argv[2], sys.argv[3]
+    others = sorted(f for f in os.listdir(sketch_dir)
+                    if f.endswith(".ino") and f != main_ino)
+    files = [main_ino] + others
+
+    chunks = []
+    protos = []
+    first_def = None
+    for name in files:
+        path = os.path.abspath(os.path.join(sketch_dir, name))
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+        found = list(prototypes(text))
+        protos += [p for _, p in found]
+        if first_def is None and found:
+            first_def = (len(chunks), found[0][0])
+        chunks.append((path, text))
+
+    with open(out, "w", encoding="utf-8") as f:
+        f.write("#include <Arduino.h>\n")
+        for idx, (path, text) in enumerate(chunks):
+            if first_def and idx == first_def[0]:
+                head, tail = text[:first_def[1]], text[first_def[1]:]
+                f.write('#line 1 "%s"\n%s\n' % (path, head))
+                f.write("\n".join(protos) + "\n")
+                line = head.count("\n") + 1
+                f.write('#line %d "%s"\n%s\n' % (line, path, tail))
+            else:
+                f.write('#line 1 "%s"\n%s\n' % (path, text))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,471 @@
+/**
+ * kbWinder host simulator.
+ *
+ * Runs the Nano firmware against a mock Arduino HAL with virtual time:
+ * setup() once, then loop() over and over while the clock advances by a
+ * modelled loop cost plus the time the UART needs to drain whatever the
+ * firmware printed. Timer1 compare-match interrupts fire at their exact
+ * virtual times, pre-empting the main loop just like on the real chip.
+ *
+ * Every digitalWrite edge is written to a trace file, serial input comes
+ * from a script, and the limit switch closes when the simulated carriage
+ * reaches position 0.
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <util/atomic.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+void setup();
+void loop();
+extern "C" void TIMER1_COMPA_vect(void);
+extern "C" __attribute__((weak)) void TIMER1_COMPA_vect(void) {}
+
+// serial.ino only implements freeMemory() for AVR and ARM targets
+int freeMemory() { return 2048; }
+
+// --- SIMULATION PARAMETERS ---
+
+struct SimOptions {
+  const char *scriptPath = nullptr;
+  const char *tracePath = nullptr;
+  const char *eepromPath = nullptr;
+  unsigned long durationMs = 10000;
+  unsigned long loopCostUs = 40;  // main loop() iteration cost
+  unsigned long isrCostNs = 6000; // Timer1 ISR cost (entry, body, exit)
+  unsigned long baud = 57600;
+  long carriageStart = 8000;      // traverse steps from the limit switch
+  bool traverseDirInverted = false;
+  bool quiet = false;
+};
+
+static SimOptions opt;
+
+// --- VIRTUAL CLOCK ---
+
+static uint64_t nowNs = 0;
+static bool interruptsEnabled = true;
+static bool inIsr = false;
+
+unsigned long micros() { return (unsigned long)(nowNs / 1000); }
+unsigned long millis() { return (unsigned long)(nowNs / 1000000); }
+
+static void advance(uint64_t ns);
+
+void delayMicroseconds(unsigned int us) {
+  if (inIsr)
+    nowNs += (uint64_t)us * 1000; // busy-wait inside the ISR, nothing can pre-empt it
+  else
+    advance((uint64_t)us * 1000);
+}
+
+void delay(unsigned long ms) { advance((uint64_t)ms * 1000000); }
+
+void cli() { interruptsEnabled = false; }
+void sei() { interruptsEnabled = true; }
+bool simInterruptsEnabled() { return interruptsEnabled; }
+
+// --- TIMER1 ---
+
+static uint64_t timerNextNs = 0;
+static bool timerRunning = false;
+
+static uint64_t timerPeriodNs() { return ((uint64_t)OCR1A.value + 1) * 500; } // clk/8 @ 16 MHz
+
+static void onTccr1bWrite(uint16_t v) {
+  bool run = (v & 0x07) != 0;
+  if (run && !timerRunning)
+    timerNextNs = nowNs + timerPeriodNs();
+  timerRunning = run;
+}
+
+static void onTcnt1Write(uint16_t) {
+  if (timerRunning)
+    timerNextNs = nowNs + timerPeriodNs();
+}
+
+SimTimerReg TCCR1A = {0, nullptr};
+SimTimerReg TCCR1B = {0, onTccr1bWrite};
+SimTimerReg TCNT1 = {0, onTcnt1Write};
+SimTimerReg OCR1A = {0xFFFF, nullptr};
+SimTimerReg TIMSK1 = {0, nullptr};
+SimTimerReg TIFR1 = {0, nullptr};
+
+static unsigned long isrCount = 0;
+static uint64_t isrLateNs = 0;
+
+static void fireTimer() {
+  uint64_t due = timerNextNs;
+  if (nowNs > due)
+    isrLateNs = std::max(isrLateNs, nowNs - due);
+  nowNs = std::max(nowNs, due);
+  TCNT1.value = (uint16_t)((nowNs - due) / 500);
+  inIsr = true;
+  interruptsEnabled = false;
+  TIMER1_COMPA_vect();
+  interruptsEnabled = true;
+  inIsr = false;
+  nowNs += opt.isrCostNs;
+  // the counter restarted from 0 at the match; a TOP reloaded by the ISR
+  // already applies to the period that is running now
+  timerNextNs = due + timerPeriodNs();
+  isrCount++;
+}
+
+// Advances the clock, letting due interrupts pre-empt the main loop.
+static void advance(uint64_t ns) {
+  uint64_t until = nowNs + ns;
+  while (timerRunning && (TIMSK1.value & _BV(OCIE1A)) && interruptsEnabled && timerNextNs <= until) {
+    nowNs = std::max(nowNs, timerNextNs);
+    fireTimer();
+    until += opt.isrCostNs; // the main loop lost that time
+  }
+  nowNs = std::max(nowNs, until);
+}
+
+// --- PINS & TRACE ---
+
+static uint8_t pinModes[20];
+static uint8_t pinLevels[20];
+static FILE *traceFile = nullptr;
+
+struct PinStats {
+  unsigned long rising = 0;
+  uint64_t lastRiseNs = 0;
+  uint64_t minIntervalNs = UINT64_MAX;
+  uint64_t maxIntervalNs = 0;
+};
+static PinStats pinStats[20];
+
+static long carriagePos = 0; // traverse steps, 0 = limit switch
+static const uint8_t T_STEP_PIN = 15;
+static const uint8_t T_DIR_PIN = 14;
+static const uint8_t LIMIT_SWITCH_PIN = 4;
+static bool limitWasPressed = false;
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < 20) {
+    pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP)
+      pinLevels[pin] = HIGH;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= 20)
+    return;
+  val = val ? HIGH : LOW;
+  if (pinLevels[pin] == val)
+    return;
+  pinLevels[pin] = val;
+  if (traceFile)
+    fprintf(traceFile, "%llu,%u,%u\n", (unsigned long long)nowNs, pin, val);
+  if (val == HIGH) {
+    PinStats &s = pinStats[pin];
+    if (s.rising > 0) {
+      uint64_t d = nowNs - s.lastRiseNs;
+      s.minIntervalNs = std::min(s.minIntervalNs, d);
+      s.maxIntervalNs = std::max(s.maxIntervalNs, d);
+    }
+    s.lastRiseNs = nowNs;
+    s.rising++;
+    if (pin == T_STEP_PIN) {
+      bool towardSwitch = (pinLevels[T_DIR_PIN] == HIGH) != opt.traverseDirInverted;
+      carriagePos += towardSwitch ? -1 : 1;
+    }
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin == LIMIT_SWITCH_PIN) {
+    bool pressed = carriagePos <= 0;
+    if (pressed && !limitWasPressed && !opt.quiet)
+      fprintf(stderr, "[sim %10.3f ms] limit switch closed\n", nowNs / 1e6);
+    limitWasPressed = pressed;
+    return pressed ? LOW : HIGH;
+  }
+  return pin < 20 ? pinLevels[pin] : LOW;
+}
+
+// --- SERIAL ---
+
+HardwareSerial Serial;
+static std::deque<uint8_t> rxBuffer;
+static std::deque<std::pair<uint64_t, std::string>> script;
+static uint64_t txBusyUntilNs = 0;
+static std::string txLine;
+
+static uint64_t byteTimeNs() { return 10ULL * 1000000000ULL / opt.baud; }
+
+void HardwareSerial::begin(unsigned long baud) { opt.baud = baud; }
+
+int HardwareSerial::available() { return (int)rxBuffer.size(); }
+
+int HardwareSerial::read() {
+  if (rxBuffer.empty())
+    return -1;
+  int c = rxBuffer.front();
+  rxBuffer.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek() { return rxBuffer.empty() ? -1 : rxBuffer.front(); }
+
+int HardwareSerial::availableForWrite() {
+  uint64_t queued = txBusyUntilNs > nowNs ? (txBusyUntilNs - nowNs + byteTimeNs() - 1) / byteTimeNs() : 0;
+  return queued >= 64 ? 0 : (int)(64 - queued);
+}
+
+// Binary telemetry frames (0x00 <COBS(payload + CRC16)> 0x00) are decoded
+// and printed as "TLM ..." lines instead of ending up in the text output.
+static bool txInFrame = false;
+static std::vector<uint8_t> txFrame;
+static unsigned long tlmFrames = 0, tlmBadFrames = 0;
+
+static uint16_t simCrc16(const uint8_t *p, size_t n) {
+  uint16_t crc = 0xFFFF;
+  while (n--) {
+    crc ^= (uint16_t)(*p++) << 8;
+    for (int i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+static int32_t le32(const uint8_t *p) { return (int32_t)(p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24); }
+
+static void decodeTelemetryFrame() {
+  std::vector<uint8_t> raw;
+  for (size_t i = 0; i < txFrame.size();) {
+    uint8_t code = txFrame[i++];
+    for (uint8_t k = 1; k < code && i < txFrame.size(); k++)
+      raw.push_back(txFrame[i++]);
+    if (code < 0xFF && i < txFrame.size())
+      raw.push_back(0);
+  }
+  if (raw.size() < 3 || simCrc16(raw.data(), raw.size() - 2) != (raw[raw.size() - 2] | raw[raw.size() - 1] << 8)) {
+    tlmBadFrames++;
+    printf("[%10.3f ms] TLM bad frame (%zu bytes)\n", nowNs / 1e6, txFrame.size());
+    return;
+  }
+  tlmFrames++;
+  if (opt.quiet)
+    return;
+  const uint8_t *p = raw.data();
+  if (p[0] == 1 && raw.size() == 24 + 2)
+    printf("[%10.3f ms] TLM #%u state=%u motor=%c q=%u flags=%02X steps=%d/%d rpm=%.2f abs=%d layer=%u\n", nowNs / 1e6, p[1], p[2],
+           p[3] ? p[3] : '-', p[5], p[4], le32(p + 6), le32(p + 10), le32(p + 14) / 256.0, le32(p + 18), p[22] | p[23] << 8);
+  else if (p[0] == 2)
+    printf("[%10.3f ms] TLM #%u event=%u\n", nowNs / 1e6, p[1], p[2]);
+  else
+    printf("[%10.3f ms] TLM unknown type %u (%zu bytes)\n", nowNs / 1e6, p[0], raw.size());
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  // 64-byte TX ring: once it is full, the caller blocks until a byte drains
+  uint64_t bt = byteTimeNs();
+  if (txBusyUntilNs > nowNs + 64 * bt)
+    advance(txBusyUntilNs - 64 * bt - nowNs);
+  txBusyUntilNs = std::max(txBusyUntilNs, nowNs) + bt;
+
+  if (c == 0) {
+    if (txInFrame && !txFrame.empty()) {
+      decodeTelemetryFrame();
+      txInFrame = false;
+    } else {
+      txInFrame = true;
+    }
+    txFrame.clear();
+  } else if (txInFrame) {
+    txFrame.push_back(c);
+  } else if (c == '\n') {
+    if (!opt.quiet)
+      printf("[%10.3f ms] %s\n", nowNs / 1e6, txLine.c_str());
+    txLine.clear();
+  } else if (c != '\r') {
+    txLine += (char)c;
+  }
+  return 1;
+}
+
+// Delivers scripted input at UART speed: one byte per byte-time.
+static uint64_t rxNextByteNs = 0;
+static std::string rxPending;
+
+void simFeedSerial() {
+  while (!script.empty() && script.front().first <= nowNs) {
+    rxPending += script.front().second + "\n";
+    script.pop_front();
+  }
+  while (!rxPending.empty() && rxNextByteNs <= nowNs) {
+    if (rxBuffer.size() < 64) // hardware RX ring; overflow drops bytes
+      rxBuffer.push_back((uint8_t)rxPending[0]);
+    rxPending.erase(0, 1);
+    rxNextByteNs = std::max(rxNextByteNs, nowNs - std::min(nowNs, byteTimeNs())) + byteTimeNs();
+  }
+}
+
+// --- EEPROM ---
+
+EEPROMClass EEPROM;
+
+static void loadEeprom() {
+  memset(EEPROM.data, 0xFF, sizeof(EEPROM.data));
+  if (!opt.eepromPath)
+    return;
+  FILE *f = fopen(opt.eepromPath, "rb");
+  if (f) {
+    fread(EEPROM.data, 1, sizeof(EEPROM.data), f);
+    fclose(f);
+  }
+}
+
+static void saveEeprom() {
+  if (!opt.eepromPath)
+    return;
+  FILE *f = fopen(opt.eepromPath, "wb");
+  if (f) {
+    fwrite(EEPROM.data, 1, sizeof(EEPROM.data), f);
+    fclose(f);
+  }
+}
+
+// --- SCRIPT ---
+
+// Each line: "<time in ms> <command>"; blank lines and '#' comments ignored.
+static bool loadScript(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), f)) {
+    char *p = line;
+    while (isspace((unsigned char)*p))
+      p++;
+    if (*p == 0 || *p == '#')
+      continue;
+    char *end;
+    double ms = strtod(p, &end);
+    while (isspace((unsigned char)*end))
+      end++;
+    std::string cmd(end);
+    while (!cmd.empty() && (cmd.back() == '\n' || cmd.back() == '\r'))
+      cmd.pop_back();
+    script.emplace_back((uint64_t)(ms * 1e6), cmd);
+  }
+  fclose(f);
+  return true;
+}
+
+// --- MAIN ---
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+      "usage: %s [options]\n"
+      "  --script FILE       serial input, lines of \"<ms> <command>\"\n"
+      "  --trace FILE        write every pin edge as \"ns,pin,level\" CSV\n"
+      "  --eeprom FILE       persist EEPROM contents between runs\n"
+      "  --duration MS       virtual run time (default 10000)\n"
+      "  --loop-cost US      cost of one loop() iteration (default 40)\n"
+      "  --isr-cost NS       cost of one Timer1 interrupt (default 6000)\n"
+      "  --carriage STEPS    traverse start distance from the switch (default 8000)\n"
+      "  --invert-traverse   T_DIR LOW moves toward the switch\n"
+      "  --quiet             do not echo serial output\n",
+      argv0);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    auto next = [&]() -> const char * {
+      if (i + 1 >= argc) {
+        usage(argv[0]);
+        exit(2);
+      }
+      return argv[++i];
+    };
+    if (a == "--script")
+      opt.scriptPath = next();
+    else if (a == "--trace")
+      opt.tracePath = next();
+    else if (a == "--eeprom")
+      opt.eepromPath = next();
+    else if (a == "--duration")
+      opt.durationMs = strtoul(next(), nullptr, 10);
+    else if (a == "--loop-cost")
+      opt.loopCostUs = strtoul(next(), nullptr, 10);
+    else if (a == "--isr-cost")
+      opt.isrCostNs = strtoul(next(), nullptr, 10);
+    else if (a == "--carriage")
+      opt.carriageStart = strtol(next(), nullptr, 10);
+    else if (a == "--invert-traverse")
+      opt.traverseDirInverted = true;
+    else if (a == "--quiet")
+      opt.quiet = true;
+    else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (opt.scriptPath && !loadScript(opt.scriptPath))
+    return 1;
+  if (opt.tracePath) {
+    traceFile = fopen(opt.tracePath, "w");
+    if (!traceFile) {
+      perror(opt.tracePath);
+      return 1;
+    }
+    fprintf(traceFile, "ns,pin,level\n");
+  }
+  loadEeprom();
+  carriagePos = opt.carriageStart;
+
+  setup();
+  uint64_t endNs = (uint64_t)opt.durationMs * 1000000ULL;
+  unsigned long loops = 0;
+  uint64_t maxLoopNs = 0;
+  while (nowNs < endNs) {
+    simFeedSerial();
+    uint64_t start = nowNs;
+    loop();
+    advance((uint64_t)opt.loopCostUs * 1000);
+    maxLoopNs = std::max(maxLoopNs, nowNs - start);
+    loops++;
+  }
+
+  if (traceFile)
+    fclose(traceFile);
+  saveEeprom();
+
+  fprintf(stderr, "\n--- SIMULATION SUMMARY ---\n");
+  fprintf(stderr, "virtual time: %.3f s, loop() calls: %lu, worst loop: %.3f ms\n", nowNs / 1e9, loops, maxLoopNs / 1e6);
+  fprintf(stderr, "timer1 interrupts: %lu, worst ISR latency: %.3f us\n", isrCount, isrLateNs / 1e3);
+  if (tlmFrames || tlmBadFrames)
+    fprintf(stderr, "telemetry frames: %lu, bad: %lu\n", tlmFrames, tlmBadFrames);
+  const char *names[20] = {};
+  names[17] = "W_STEP";
+  names[15] = "T_STEP";
+  for (int pin = 0; pin < 20; pin++) {
+    if (!names[pin] || pinStats[pin].rising == 0)
+      continue;
+    const PinStats &s = pinStats[pin];
+    fprintf(stderr, "%-7s steps: %lu", names[pin], s.rising);
+    if (s.rising > 1)
+      fprintf(stderr,
+          ", interval min/max: %.2f/%.2f us, peak rate: %.0f steps/s",
+          s.minIntervalNs / 1e3,
+          s.maxIntervalNs / 1e3,
+          1e9 / s.minIntervalNs);
+    fprintf(stderr, "\n");
+  }
+  fprintf(stderr, "carriage: %ld steps from switch, EEPROM writes: %lu\n", carriagePos, EEPROM.writes);
+  return 0;
+}
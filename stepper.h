@@ -0,0 +1,30 @@
+#ifndef STEPPER_H
+#define STEPPER_H
+
+#include <util/atomic.h>
+
+// --- TIMER1 STEP ENGINE ---
+// Timer1 in CTC mode, clk/8: one tick = 0.5 us on the 16 MHz Nano.
+// The compare-match ISR owns the W_STEP/T_STEP pulses; the main loop only
+// feeds it the active task and the step interval (see executeMotion()).
+
+#define STEPPER_TICKS_PER_US 2
+#define STEPPER_TICKS_PER_MIN 120000000UL
+#define STEPPER_MIN_TICKS 40     // 20 us - leaves room for the ISR itself
+#define STEPPER_MAX_TICKS 65535U // ~32.7 ms, slower moves are clamped
+
+Task *volatile stepperTask = NULL;          // task being stepped by the ISR
+Task *volatile stepperNextTask = NULL;      // blended task to continue with
+volatile uint16_t stepperTicks = STEPPER_MAX_TICKS; // next period (OCR1A)
+volatile bool stepperHalted = false;        // limit switch hit, ISR waits
+volatile bool stepperLayerFlipped = false;  // set by ISR, printed by loop()
+
+void stepperBegin();
+void stepperStart(Task *t);
+void stepperStop();
+Task *stepperFinish(Task *t);
+void stepperSetTicks(unsigned long ticks);
+long stepperReadSteps(Task *t);
+long stepperReadPosition();
+
+#endif // STEPPER_H
@@ -0,0 +1,112 @@
+#include "stepper.h"
+
+// --- TIMER1 SETUP ---
+
+void stepperBegin() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR1A = 0;
+    TCCR1B = 0; // timer stopped until the first task starts
+    TCNT1 = 0;
+    OCR1A = STEPPER_MAX_TICKS;
+    TIMSK1 &= ~_BV(OCIE1A);
+  }
+}
+
+// Attaches a task to the ISR and (re)starts the timer with the current
+// stepperTicks period. Safe to call again after a pause.
+void stepperStart(Task *t) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    stepperTask = t;
+    stepperHalted = false;
+    OCR1A = stepperTicks;
+    TCNT1 = 0;
+    TIFR1 = _BV(OCF1A); // drop a compare match left over from the last task
+    TIMSK1 |= _BV(OCIE1A);
+    TCCR1B = _BV(WGM12) | _BV(CS11); // CTC on OCR1A, clk/8
+  }
+}
+
+void stepperStop() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR1B = 0;
+    TIMSK1 &= ~_BV(OCIE1A);
+    stepperTask = NULL;
+    stepperHalted = false;
+    // A prepared blend is void once we stop: the next task starts from rest
+    if (stepperNextTask != NULL)
+      stepperNextTask->isStarted = false;
+    stepperNextTask = NULL;
+  }
+}
+
+// Releases a finished task. Returns the chained task the engine continues
+// with (the ISR may already have switched to it), or NULL after stopping.
+Task *stepperFinish(Task *t) {
+  Task *next = NULL;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (stepperTask == t && stepperNextTask != NULL) {
+      stepperTask = stepperNextTask;
+      stepperNextTask = NULL;
+    }
+    if (stepperTask != t && stepperTask != NULL)
+      next = stepperTask;
+  }
+  if (next == NULL)
+    stepperStop();
+  return next;
+}
+
+// Sets the interval between steps (in 0.5 us ticks). The ISR picks it up on
+// its next run, so the period currently being counted is never cut short or
+// stretched.
+void stepperSetTicks(unsigned long ticks) {
+  if (ticks > STEPPER_MAX_TICKS)
+    ticks = STEPPER_MAX_TICKS;
+  if (ticks < STEPPER_MIN_TICKS)
+    ticks = STEPPER_MIN_TICKS;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { stepperTicks = ticks - 1; }
+}
+
+// --- SNAPSHOTS FOR THE MAIN LOOP ---
+// 32-bit values written by the ISR have to be read with interrupts off.
+
+long stepperReadSteps(Task *t) {
+  long steps;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { steps = t->currentSteps; }
+  return steps;
+}
+
+long stepperReadPosition() {
+  long pos;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { pos = absPos; }
+  return pos;
+}
+
+// --- STEP ISR ---
+
+ISR(TIMER1_COMPA_vect) {
+  // TCNT1 restarted at the compare match, so it tells how late we are
+  uint16_t latency = TCNT1;
+  uint16_t period = OCR1A;
+
+  // TCNT1 has just been cleared, so a new TOP is safe to load here
+  OCR1A = stepperTicks;
+
+  Task *t = stepperTask;
+  if (t == NULL || stepperHalted)
+    return;
+  if (t->currentSteps >= t->targetSteps) {
+    // Blend straight into the next task if loop() has prepared one
+    t = stepperNextTask;
+    if (t == NULL)
+      return; // nothing to do until loop() hands over the next segment
+    stepperTask = t;
+    stepperNextTask = NULL;
+    if (t->currentSteps >= t->targetSteps)
+      return;
+  }
+
+  stepActiveMotor(t);
+  t->currentSteps++;
+  perfRecordStep(latency, period);
+}
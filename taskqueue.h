@@ -1,39 +1,95 @@
 #ifndef TASKQUEUE_H
 #define TASKQUEUE_H
 
+// RPM values are fixed point: RPM << RPM_SHIFT (1/256 RPM resolution), so the
+// ramp runs on integer adds only. RAMP_TICK_MS is the ramp update period.
+#define RPM_SHIFT 8
+#define RPM_Q(rpm) ((uint32_t)(rpm) << RPM_SHIFT)
+#define RPM_TO_FLOAT(q) ((float)(q) / (1 << RPM_SHIFT))
+#define FLOAT_TO_RPM(f) ((uint32_t)((f) * (1 << RPM_SHIFT)))
+#define RAMP_TICK_MS 10
+
+// S-curve ramps keep the acceleration with ACCEL_SHIFT more fractional bits
+// (RPM_Q() << ACCEL_SHIFT per tick), so a gentle jerk still moves it every
+// tick. JERK_MAX_TICKS caps how long reaching full acceleration may take.
+#define ACCEL_SHIFT 8
+#define JERK_MAX_TICKS 255
+
+// --- LIVE TASK ---
+// Full execution state, only kept for the current task and the one chained
+// after it (see taskSlots below). Everything the ISR needs lives here.
 struct Task {
   MachineState state;
   MachineState prevState;  // needed for pausing/resuming
   char motor;              // 'W', 'T' lub 'S' (Synchronized)
-  bool isRelative;
+  bool isRelative : 1;
+  bool isStarted : 1;
+  bool isDecelerating : 1;
+  bool isComplete : 1;
+  bool isJogMove : 1;
   long targetPosition;  // absolute
   long targetSteps;     // relative
-  int dir;              // direction (-1 backward | 0 not set | 1 forward)
+  int8_t dir;           // direction (-1 backward | 0 not set | 1 forward)
   long currentSteps;    // steps counter
-  long accelDistance;   // how many steps it took to accelerate
-  float startRPM;
-  float targetRPM;
-  float currentRPM;
-  int accelRate;           // RPM/s (np. 100 oznacza wzrost o 100 RPM w sekundę)
-  unsigned long cachedDelay;     // Przeliczony interwał w mikrosekundach
+  long decelSteps;      // braking starts this many steps before target
+  uint16_t startRPM;       // whole RPM
+  uint16_t targetRPM;      // whole RPM
+  uint16_t exitRPM;        // whole RPM handed over to the next task, 0 = stop
+  uint32_t currentRPM;     // RPM_Q()
+  uint8_t accelRate;       // RPM/s (np. 100 oznacza wzrost o 100 RPM w sekundę)
+  uint16_t rampStep;       // RPM_Q() added/removed every RAMP_TICK_MS
+  uint32_t jerkStep;       // rampAccel change per tick, 0 = linear ramp
+  uint32_t accelMax;       // rampAccel limit, a multiple of jerkStep
+  int32_t rampAccel;       // RPM_Q() << ACCEL_SHIFT per tick, < 0 slowing
+  uint32_t rampBrake;      // speed still gained while rampAccel eases to 0
+  uint8_t rpmFraction;     // currentRPM below RPM_Q() resolution
+  uint32_t delayNumerator; // timer ticks per step at 1 RPM, << RPM_SHIFT
+  uint16_t cachedDelay;          // Przeliczony interwał w tickach Timer1 (0.5 us)
   unsigned long lastRampUpdate;  // Czas ostatniej zmiany RPM (ms) 
-  bool isStarted;
-  bool isDecelerating;
-  bool isComplete;
-  bool isJogMove;
-  unsigned long taskStarted;
-  unsigned long taskLastPinged;
 };
 
-#define QUEUE_SIZE 3
-Task taskQueue[QUEUE_SIZE];
-int head = 0;  // Index of the current task
-int tail = 0;  // Index where next task will be added
+// --- SEGMENT QUEUE ---
+// What is waiting to be done, 9 bytes per entry, so a whole multi-stage
+// job fits on the Nano. A segment becomes a live Task when it reaches the
+// head of the queue (or right behind it, to be blended into).
+enum SegmentMotor { SEG_W, SEG_T, SEG_S };
+
+#define SEG_RPM_BITS 12
+#define SEG_RAMP_BITS 8
+#define SEG_RAMP_MAX ((1 << SEG_RAMP_BITS) - 1)
+static_assert(MAX_RPM < (1 << SEG_RPM_BITS), "Segment::rpm cannot hold MAX_RPM");
+static_assert(MAX_RAMP <= SEG_RAMP_MAX, "Segment::ramp cannot hold MAX_RAMP");
+static_assert(SEG_RAMP_MAX <= UINT8_MAX, "Task::accelRate cannot hold Segment::ramp");
+
+struct Segment {
+  uint8_t state : 3;      // MachineState
+  uint8_t motor : 2;      // SegmentMotor
+  uint8_t isRelative : 1;
+  uint8_t isJogMove : 1;
+  long target;            // relative: signed steps, absolute: position
+  uint32_t rpm : SEG_RPM_BITS;     // target RPM, 1..MAX_RPM
+  uint32_t exitRPM : SEG_RPM_BITS; // set by planQueue(), 0 = stop
+  uint32_t ramp : SEG_RAMP_BITS;   // RPM/s
+};
+
+#define QUEUE_SIZE 16
+Segment segmentQueue[QUEUE_SIZE];
+uint8_t head = 0;  // Index of the current task
+uint8_t tail = 0;  // Index where next task will be added
 int taskCount = 0;
 
+// taskSlots[liveHead] is the current task, the other slot the next one.
+// Slots are filled lazily by getCurrentTask() / getNextTask().
+Task taskSlots[2];
+uint8_t liveHead = 0;
+bool currentLoaded = false;
+bool nextLoaded = false;
+
 bool enqueueTask(MachineState s, char m, long target, bool isRelative, int rpm,
-                 float ramp);
+                 int ramp, bool isJogMove);
 Task *getCurrentTask();
+Task *getNextTask();
+void planQueue();
 void dequeueTask();
 void clearQueue();
 
@@ -21,7 +21,7 @@ void debugEnqueueTask(MachineState s, char m, long target, bool isRelative,
   Serial.println(")");
 }
 
-bool printTaskDebug(Task *t) {
+void printTaskDebug(Task *t) {
   if (t == NULL) {
     Serial.println(F("DEBUG: No active task to print."));
     return;
@@ -42,13 +42,15 @@ bool printTaskDebug(Task *t) {
   Serial.print(F("TARGET_STEPS: ")); Serial.println(t->targetSteps);
   Serial.print(F("DIR: ")); Serial.println(t->dir);
   Serial.print(F("CUR_STEPS: ")); Serial.println(t->currentSteps);
-  Serial.print(F("ACCEL_DIST: ")); Serial.println(t->accelDistance);
+  Serial.print(F("DECEL_STEPS: ")); Serial.println(t->decelSteps);
   
   // Prędkości i Rampa (floaty)
   Serial.print(F("START_RPM: ")); Serial.println(t->startRPM);
   Serial.print(F("TARGET_RPM: ")); Serial.println(t->targetRPM);
-  Serial.print(F("CUR_RPM: ")); Serial.println(t->currentRPM);
+  Serial.print(F("CUR_RPM: ")); Serial.println(RPM_TO_FLOAT(t->currentRPM));
+  Serial.print(F("EXIT_RPM: ")); Serial.println(t->exitRPM);
   Serial.print(F("ACCEL_RATE: ")); Serial.println(t->accelRate);
+  Serial.print(F("JERK_STEP: ")); Serial.println(t->jerkStep);
   
   // Timingi i Cache
   Serial.print(F("CACHED_DELAY: ")); Serial.println(t->cachedDelay);
@@ -60,9 +62,10 @@ bool printTaskDebug(Task *t) {
   Serial.print(F("IS_COMPLETE: ")); Serial.println(t->isComplete);
   Serial.print(F("IS_JOG: ")); Serial.println(t->isJogMove);
   
-  // Watchdog i start
-  Serial.print(F("TASK_STARTED: ")); Serial.println(t->taskStarted);
-  Serial.print(F("LAST_PING: ")); Serial.println(t->taskLastPinged);
+  // Watchdog (tylko JOG)
+  if (t->isJogMove) {
+    Serial.print(F("LAST_PING: ")); Serial.println(jogLastPinged);
+  }
   
   Serial.println(F("--- TASK DUMP END ---"));
 }
@@ -77,61 +80,208 @@ bool enqueueTask(MachineState s, char m, long target, bool isRelative, int rpm,
     return false;
   }
 
-  Task &t = taskQueue[tail];
-  t.state = s;
-  t.motor = m;
-  t.isRelative = isRelative;
-  if (isRelative) {
-    t.dir = (target >= 0) ? 1 : -1;
-    t.targetSteps = abs(target);
-    t.targetPosition = NAN; // will be set when starting the task
-  } else {
-    t.targetPosition = target;
-    t.targetSteps = NAN; // will be set when starting the task
-    t.dir = 0;           // will be set when starting the task
+  if (rpm <= 0) {
+    Serial.println(F("ERROR: RPM must be greater than 0."));
+    return false;
   }
-  t.currentSteps = 0;
-  t.accelDistance = 0;
-
-  int absoluteMax = (m == 'W' || m == 'S') ? cfg.maxRPM_W : cfg.maxRPM_T;
+  int absoluteMax = min((m == 'W' || m == 'S') ? cfg.maxRPM_W : cfg.maxRPM_T, MAX_RPM);
   if (rpm > absoluteMax) {
     Serial.println("WARNING: Requested RPM exceeds maximum. Limiting to max.");
     rpm = absoluteMax;
   };
 
-  t.startRPM = (t.motor == 'W')
+  Segment &seg = segmentQueue[tail];
+  seg.state = s;
+  seg.motor = (m == 'W') ? SEG_W : (m == 'T') ? SEG_T : SEG_S;
+  seg.isRelative = isRelative;
+  seg.isJogMove = isJogMove;
+  seg.target = target;
+  seg.rpm = rpm;
+  seg.ramp = constrain(ramp, 0, SEG_RAMP_MAX);
+  seg.exitRPM = 0;
+
+  tail = (tail + 1) % QUEUE_SIZE;
+  taskCount++;
+  planQueue();
+  return true;
+}
+
+char segmentMotor(const Segment *seg) {
+  return (seg->motor == SEG_W) ? 'W' : (seg->motor == SEG_T) ? 'T' : 'S';
+}
+
+uint16_t segmentStartRPM(const Segment *seg) {
+  uint16_t startRPM = (seg->motor == SEG_W)
                    ? cfg.startRPM_W
                    : cfg.startRPM_T; // or should we ask active preset for this,
                                      // as wire diameter may affect startRPM?
-  t.targetRPM = (float)rpm;
-
-  if (t.startRPM > t.targetRPM) {
-    t.startRPM = t.targetRPM / 2; // safe startRPM when target is low
+  if (startRPM > seg->rpm) {
+    startRPM = seg->rpm / 2; // safe startRPM when target is low
   }
+  return startRPM;
+}
 
-  t.currentRPM = t.startRPM;
-  t.accelRate = ramp;
-  t.isStarted = false;
-  t.isDecelerating = false;
-  t.isComplete = false;
+// Expands a queued segment into a fresh live task
+void loadTask(Task *t, const Segment *seg) {
+  t->state = (MachineState)seg->state;
+  t->prevState = IDLE;
+  t->motor = segmentMotor(seg);
+  t->isRelative = seg->isRelative;
+  if (seg->isRelative) {
+    t->dir = (seg->target >= 0) ? 1 : -1;
+    t->targetSteps = abs(seg->target);
+    t->targetPosition = 0; // will be set when starting the task
+  } else {
+    t->targetPosition = seg->target;
+    t->targetSteps = 0; // will be set when starting the task
+    t->dir = 0;         // will be set when starting the task
+  }
+  t->currentSteps = 0;
+  t->decelSteps = 0;
 
-  t.isJogMove = isJogMove;
-  // t.taskRequested = millis();
-  t.taskStarted = 0;
-  t.taskLastPinged = 0;
+  t->startRPM = segmentStartRPM(seg);
+  t->targetRPM = seg->rpm;
+  t->currentRPM = RPM_Q(t->startRPM);
+  t->exitRPM = seg->exitRPM;
+  t->accelRate = seg->ramp;
+  t->isStarted = false;
+  t->isDecelerating = false;
+  t->isComplete = false;
 
-  tail = (tail + 1) % QUEUE_SIZE;
-  taskCount++;
-  return true;
+  t->isJogMove = seg->isJogMove;
 }
 
 Task *getCurrentTask() {
-  if (taskCount > 0)
-    return &taskQueue[head];
+  if (taskCount == 0)
+    return NULL;
+  if (!currentLoaded) {
+    loadTask(&taskSlots[liveHead], &segmentQueue[head]);
+    currentLoaded = true;
+  }
+  return &taskSlots[liveHead];
+}
+
+Task *getNextTask() {
+  if (taskCount < 2)
+    return NULL;
+  if (!nextLoaded) {
+    loadTask(&taskSlots[liveHead ^ 1], &segmentQueue[(head + 1) % QUEUE_SIZE]);
+    nextLoaded = true;
+  }
+  return &taskSlots[liveHead ^ 1];
+}
+
+// Live task of queue position n (0 = current, 1 = next) if it has been
+// expanded already, so the planner can use its real progress.
+Task *getLoadedTask(int n) {
+  if (n == 0 && currentLoaded)
+    return &taskSlots[liveHead];
+  if (n == 1 && nextLoaded)
+    return &taskSlots[liveHead ^ 1];
   return NULL;
 }
 
-String getTaskStateStr(MachineState state) {
+// --- LOOK-AHEAD PLANNER ---
+// Decides at which speed each queued task may hand over to the next one
+// (exitRPM, 0 = full stop). Only back-to-back MOVING tasks of the same motor
+// going the same way are blended; the last task in the queue always stops.
+
+bool canBlendSegments(const Segment *a, const Segment *b) {
+  return a->state == MOVING && b->state == MOVING && a->motor == b->motor &&
+         !a->isJogMove && !b->isJogMove;
+}
+
+// Seconds an S-curve ramp takes to reach full acceleration (see
+// prepareTask()), 0 for a linear ramp
+float jerkTime(int ramp, int jerk) {
+  if (jerk <= 0 || ramp <= 0)
+    return 0;
+  long ticks = (long)ramp * (1000 / RAMP_TICK_MS) / jerk;
+  return constrain(ticks, 1, JERK_MAX_TICKS) * RAMP_TICK_MS / 1000.0;
+}
+
+void planQueue() {
+  int8_t dirs[QUEUE_SIZE];
+  long lengths[QUEUE_SIZE];
+  bool known[QUEUE_SIZE];
+
+  // Forward pass: predict where each task starts, so absolute GOTOs get
+  // a direction and length before they are started
+  long pos = stepperReadPosition();
+  bool posKnown = true;
+  for (int n = 0; n < taskCount; n++) {
+    Segment *seg = &segmentQueue[(head + n) % QUEUE_SIZE];
+    Task *t = getLoadedTask(n);
+    known[n] = posKnown || seg->isRelative;
+    if (t != NULL && t->isStarted) {
+      dirs[n] = t->dir;
+      lengths[n] = t->targetSteps - stepperReadSteps(t);
+      if (seg->motor == SEG_T || seg->state == HOMING)
+        pos = t->targetPosition; // W tasks leave the traverse where it is
+    } else if (seg->isRelative) {
+      dirs[n] = (seg->target >= 0) ? 1 : -1;
+      lengths[n] = abs(seg->target);
+      if (seg->motor == SEG_T)
+        pos += seg->target;
+    } else {
+      long diff = seg->target - pos;
+      dirs[n] = (diff >= 0) ? 1 : -1;
+      lengths[n] = abs(diff);
+      pos = seg->target;
+    }
+    if (seg->state == HOMING) {
+      pos = 0;
+      posKnown = true;
+    } else if (seg->state == RUNNING) {
+      posKnown = false; // traverse ends wherever the last layer ended
+    }
+  }
+
+  // Backward pass: a task may only hand over as fast as the next one can
+  // still brake to its own exit speed: v^2 = vExit^2 + 120 * a * revs, and
+  // an S-curve brakes jerkTime s longer: v^2 + a * jerkTime * (v + vExit)
+  float nextExit = 0;
+  for (int n = taskCount - 1; n >= 0; n--) {
+    Segment *seg = &segmentQueue[(head + n) % QUEUE_SIZE];
+    Task *t = getLoadedTask(n);
+    float exitRPM = 0;
+    if (n < taskCount - 1) {
+      Segment *next = &segmentQueue[(head + n + 1) % QUEUE_SIZE];
+      // A paused (or failed) task has left its queued state: no handover
+      bool halted = (t != NULL && t->state != seg->state);
+      if (!halted && canBlendSegments(seg, next) && known[n] &&
+          known[n + 1] && dirs[n] == dirs[n + 1]) {
+        bool winder = (next->motor == SEG_W);
+        int spr = winder ? cfg.stepsPerRevW : cfg.stepsPerRevT;
+        float brakeFrom = segmentStartRPM(next);
+        if (nextExit > brakeFrom)
+          brakeFrom = nextExit;
+        float aj = next->ramp * jerkTime(next->ramp, winder ? cfg.jerk_W
+                                                             : cfg.jerk_T);
+        float reachable =
+            (sqrt(aj * aj + 4 * (brakeFrom * brakeFrom - aj * brakeFrom +
+                                 120.0 * next->ramp * lengths[n + 1] / spr)) -
+             aj) / 2;
+        exitRPM = min((uint16_t)seg->rpm, (uint16_t)next->rpm);
+        if (exitRPM > reachable)
+          exitRPM = reachable;
+        if (exitRPM <= segmentStartRPM(seg))
+          exitRPM = 0; // not worth it, stop as usual
+      }
+    }
+    seg->exitRPM = (uint16_t)exitRPM; // whole RPM, rounded down
+    if (t != NULL && t->exitRPM != seg->exitRPM) {
+      t->exitRPM = seg->exitRPM;
+      if (t->isStarted) {
+        t->targetRPM = seg->rpm; // may have been a triangle's peak
+        planTaskRamp(t);
+      }
+    }
+    nextExit = seg->exitRPM;
+  }
+}
+
+const __FlashStringHelper *getTaskStateStr(MachineState state) {
   switch (state) {
   case HOMING:
     return F("HOMING");
@@ -146,13 +296,18 @@ String getTaskStateStr(MachineState state) {
   case ERROR:
     return F("ERROR");
   }
-  return "";
+  return F("");
 }
 
+// The slot of the finished task becomes the next-task slot, but is only
+// reloaded by getNextTask(), so the caller may still read it.
 void dequeueTask() {
   if (taskCount > 0) {
     head = (head + 1) % QUEUE_SIZE;
     taskCount--;
+    liveHead ^= 1;
+    currentLoaded = nextLoaded;
+    nextLoaded = false;
   }
 }
 
@@ -160,4 +315,6 @@ void clearQueue() {
   head = 0;
   tail = 0;
   taskCount = 0;
-}
\ No newline at end of file
+  currentLoaded = false;
+  nextLoaded = false;
+}
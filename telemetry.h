@@ -0,0 +1,53 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// --- BINARY TELEMETRY ---
+// Opt-in (TELEMETRY ON) machine state for the ESP, sent next to the text
+// console. Each frame is 0x00 <COBS(payload + CRC16)> 0x00: text lines never
+// contain a zero byte, so the ESP can pick the frames out of the stream.
+// Multi-byte fields are little endian. CRC-16/CCITT (poly 0x1021, init
+// 0xFFFF) covers the payload.
+#define TLM_STATUS 1 // periodic snapshot, TlmStatus below
+#define TLM_EVENT 2  // one-off event: {type, seq, code}
+
+#define TLM_EV_TASK_DONE 1
+#define TLM_EV_LAYER_FLIP 2
+#define TLM_EV_HOMED 3
+#define TLM_EV_ALARM 4 // limit switch emergency stop
+#define TLM_EV_ERROR 5
+
+// Status flags
+#define TLM_F_LAYER_FWD 0x01 // layerDir == 1
+#define TLM_F_HOMED 0x02
+#define TLM_F_PAUSE_REQ 0x04
+#define TLM_F_HALTED 0x08
+
+struct TlmStatus {
+  uint8_t type;         // TLM_STATUS
+  uint8_t seq;          // wraps, lets the ESP count lost frames
+  uint8_t state;        // MachineState of the current task, IDLE if none
+  char motor;           // 'W', 'T', 'S' or 0
+  uint8_t flags;        // TLM_F_*
+  uint8_t queued;       // taskCount
+  int32_t currentSteps;
+  int32_t targetSteps;
+  uint32_t rpm;         // RPM_Q()
+  int32_t absPos;
+  uint16_t layer;       // layers finished since START
+} __attribute__((packed));
+
+#define TLM_MAX_PAYLOAD (sizeof(TlmStatus) + 2) // + CRC
+#define TLM_MAX_FRAME (TLM_MAX_PAYLOAD + 3)     // + COBS code + 2 delimiters
+#define TLM_DEFAULT_PERIOD_MS 100
+#define TLM_MIN_PERIOD_MS 20
+
+bool telemetryEnabled = false;
+unsigned int telemetryPeriod = TLM_DEFAULT_PERIOD_MS;
+unsigned long telemetryLastSent = 0;
+uint8_t telemetrySeq = 0;
+
+void handleTelemetryCommand(char *args);
+void telemetryPoll();
+void telemetryEvent(uint8_t code);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,116 @@
+#include "telemetry.h"
+
+// --- FRAMING ---
+
+uint16_t crc16(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// Appends the CRC, COBS encodes and writes one frame. Returns false (and
+// sends nothing) if the TX buffer can't take it without blocking.
+bool telemetrySend(uint8_t *payload, uint8_t len, bool mayBlock) {
+  uint16_t crc = crc16(payload, len);
+  payload[len++] = crc & 0xFF;
+  payload[len++] = crc >> 8;
+
+  uint8_t frame[TLM_MAX_FRAME];
+  uint8_t out = 0;
+  frame[out++] = 0;
+  uint8_t codeAt = out++;
+  uint8_t code = 1;
+  for (uint8_t i = 0; i < len; i++) {
+    if (payload[i] == 0) {
+      frame[codeAt] = code;
+      codeAt = out++;
+      code = 1;
+    } else {
+      frame[out++] = payload[i];
+      code++; // payload < 254 bytes, so a block never overflows
+    }
+  }
+  frame[codeAt] = code;
+  frame[out++] = 0;
+
+  if (!mayBlock && Serial.availableForWrite() < out)
+    return false;
+  Serial.write(frame, out);
+  return true;
+}
+
+// --- STATUS / EVENTS ---
+
+void telemetryPoll() {
+  if (!telemetryEnabled || millis() - telemetryLastSent < telemetryPeriod)
+    return;
+
+  uint8_t payload[TLM_MAX_PAYLOAD];
+  TlmStatus *s = (TlmStatus *)payload;
+  Task *t = getCurrentTask();
+
+  s->type = TLM_STATUS;
+  s->seq = telemetrySeq;
+  s->state = (t != NULL) ? t->state : IDLE;
+  s->motor = (t != NULL) ? t->motor : 0;
+  s->queued = taskCount;
+  s->targetSteps = (t != NULL) ? t->targetSteps : 0;
+  s->rpm = (t != NULL && t->isStarted) ? t->currentRPM : 0;
+  s->flags = 0;
+  if (isHomed)
+    s->flags |= TLM_F_HOMED;
+  if (isPauseRequested)
+    s->flags |= TLM_F_PAUSE_REQ;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    s->currentSteps = (t != NULL) ? t->currentSteps : 0;
+    s->absPos = absPos;
+    s->layer = layerCount;
+    if (layerDir == 1)
+      s->flags |= TLM_F_LAYER_FWD;
+    if (stepperHalted)
+      s->flags |= TLM_F_HALTED;
+  }
+
+  // Busy UART: try again on the next loop() instead of waiting for it
+  if (!telemetrySend(payload, sizeof(TlmStatus), false))
+    return;
+  telemetrySeq++;
+  telemetryLastSent = millis();
+}
+
+void telemetryEvent(uint8_t code) {
+  if (!telemetryEnabled)
+    return;
+  uint8_t payload[3 + 2];
+  payload[0] = TLM_EVENT;
+  payload[1] = telemetrySeq++;
+  payload[2] = code;
+  telemetrySend(payload, 3, true);
+}
+
+// TELEMETRY [ON [period ms]|OFF]
+void handleTelemetryCommand(char *args) {
+  char *arg = nextToken(&args);
+  if (arg != NULL) {
+    if (strcmp_P(arg, PSTR("ON")) == 0) {
+      char *period = nextToken(&args);
+      if (period != NULL)
+        telemetryPeriod = max(atoi(period), TLM_MIN_PERIOD_MS);
+      telemetryEnabled = true;
+      telemetryLastSent = millis() - telemetryPeriod; // first frame right away
+    } else if (strcmp_P(arg, PSTR("OFF")) == 0) {
+      telemetryEnabled = false;
+    } else {
+      Serial.println(F("ERROR: TELEMETRY [ON [ms]|OFF]"));
+      return;
+    }
+  }
+  Serial.print(F("MSG: Telemetry "));
+  Serial.print(telemetryEnabled ? F("ON, every ") : F("OFF, period "));
+  Serial.print(telemetryPeriod);
+  Serial.println(F(" ms"));
+}
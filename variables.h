@@ -13,58 +13,80 @@ enum VarCategory { C_MACHINE,
                    C_PRESET,
                    C_RUNTIME };  // Distinction for EEPROM logic
 
+// Per-entry format flags
+#define VF_NONE 0
+#define VF_DIRECTION 0x01 // bool shown/parsed as FORWARD/BACKWARD
+
 struct VarMap {
-  const char *label;
-  void *ptr;
-  VarType type;
-  VarCategory category;
+  char label[23]; // longest: "TRAVERSE STEPS PER REV"
+  const void *ptr;
+  uint8_t type;     // VarType
+  uint8_t category; // VarCategory
   uint8_t maxLen;
+  uint8_t flags;    // VF_*
 };
 
 // --- VARIABLE TABLE ---
-// Categorizing variables to handle auto-save for machine config
-VarMap varTable[] = { { "SCREW PITCH", &cfg.screwPitch, T_FLOAT, C_MACHINE, 0 },
-                      { "WINDER STEPS PER REV", &cfg.stepsPerRevW, T_INT, C_MACHINE, 0 },
-                      { "TRAVERSE STEPS PER REV", &cfg.stepsPerRevT, T_INT, C_MACHINE, 0 },
-                      { "WINDER MAX SPEED", &cfg.maxRPM_W, T_INT, C_MACHINE, 0 },
-                      { "TRAVERSE MAX SPEED", &cfg.maxRPM_T, T_INT, C_MACHINE, 0 },
-                      { "WINDER START SPEED", &cfg.startRPM_W, T_INT, C_MACHINE, 0 },
-                      { "TRAVERSE START SPEED", &cfg.startRPM_T, T_INT, C_MACHINE, 0 },
-                      { "WINDER DEFAULT RAMP", &cfg.defaultRamp_W, T_INT, C_MACHINE, 0 },
-                      { "TRAVERSE DEFAULT RAMP", &cfg.defaultRamp_T, T_INT, C_MACHINE, 0 },          
-                      { "WINDER DIRECTION", &cfg.dirW, T_BOOL, C_MACHINE, 0 },
-                      { "TRAVERSE DIRECTION", &cfg.dirT, T_BOOL, C_MACHINE, 0 },
-                      { "LIMIT SWITCH", &cfg.useLimitSwitch, T_BOOL, C_MACHINE, 0 },
-                      { "HOME BEFORE START", &cfg.homeBeforeStart, T_BOOL, C_MACHINE, 0 },
-                      { "USE START OFFSET", &cfg.useStartOffset, T_BOOL, C_MACHINE, 0 },
-                      { "BACKOFF DISTANCE", &cfg.backoffDistanceMM, T_FLOAT, C_MACHINE, 0 },
-
-                      { "NAME", active.name, T_CHAR, C_PRESET, 15 },
-                      { "WIRE", &active.wireDia, T_FLOAT, C_PRESET, 0 },
-                      { "COIL LENGTH", &active.coilWidth, T_FLOAT, C_PRESET, 0 },
-                      { "TURNS", &active.totalTurns, T_LONG, C_PRESET, 0 },
-                      { "TARGET RPM", &active.targetRPM, T_INT, C_PRESET, 0 },
-                      { "RAMP", &active.rampRPM, T_INT, C_PRESET, 0 },
-                      { "START OFFSET", &active.startOffset, T_FLOAT, C_PRESET, 0 },
-
-                      { "POSITION", &absPos, T_LONG, C_RUNTIME, 0 },
-                      { "OS VERSION", &version, T_CHAR, C_RUNTIME, 0 },
-                      { "IS PAUSE REQUESTED", &isPauseRequested, T_BOOL, C_RUNTIME, 0 },
-
-                      { "STEPS PER MM", &stepsPerMM, T_FLOAT, C_RUNTIME, 0 },
-                      { "IS HOMED", &isHomed, T_BOOL, C_RUNTIME, 0 },
-//                      { "HOMING PHASE", &homingPhase, T_INT, C_RUNTIME, 0 },
-
-                      { "LAST STEP MICROS", &lastStepMicros, T_LONG, C_RUNTIME, 0 },
-//                      { "TRAVERSE ACCUMULATOR", &traverseAccumulator, T_FLOAT, C_RUNTIME, 0 },
-                      { "CURRENT LAYER STEPS", &currentLayerSteps, T_LONG, C_RUNTIME, 0 },
-                      { "LAYER DIRECTION", &layerDir, T_INT, C_RUNTIME, 0 } };
+// Lives in flash. Sorted by label (checked below at compile time), so SET/GET
+// find an entry by binary search; categorizing variables handles auto-save
+// for machine config.
+constexpr VarMap varTable[] PROGMEM = {
+    {"BACKOFF DISTANCE", &cfg.backoffDistanceMM, T_FLOAT, C_MACHINE, 0, VF_NONE},
+    {"COIL LENGTH", &active.coilWidth, T_FLOAT, C_PRESET, 0, VF_NONE},
+    {"CURRENT LAYER STEPS", &currentLayerSteps, T_LONG, C_RUNTIME, 0, VF_NONE},
+    {"HOME BEFORE START", &cfg.homeBeforeStart, T_BOOL, C_MACHINE, 0, VF_NONE},
+//  {"HOMING PHASE", &homingPhase, T_INT, C_RUNTIME, 0, VF_NONE},
+    {"IS HOMED", &isHomed, T_BOOL, C_RUNTIME, 0, VF_NONE},
+    {"IS PAUSE REQUESTED", &isPauseRequested, T_BOOL, C_RUNTIME, 0, VF_NONE},
+    {"LAYER DIRECTION", &layerDir, T_INT, C_RUNTIME, 0, VF_NONE},
+    {"LIMIT SWITCH", &cfg.useLimitSwitch, T_BOOL, C_MACHINE, 0, VF_NONE},
+    {"NAME", active.name, T_CHAR, C_PRESET, 15, VF_NONE},
+    {"OS VERSION", version, T_CHAR, C_RUNTIME, 0, VF_NONE},
+    {"POSITION", &absPos, T_LONG, C_RUNTIME, 0, VF_NONE},
+    {"RAMP", &active.rampRPM, T_INT, C_PRESET, 0, VF_NONE},
+    {"SCREW PITCH", &cfg.screwPitch, T_FLOAT, C_MACHINE, 0, VF_NONE},
+    {"START OFFSET", &active.startOffset, T_FLOAT, C_PRESET, 0, VF_NONE},
+    {"STEPS PER MM", &stepsPerMM, T_FLOAT, C_RUNTIME, 0, VF_NONE},
+    {"TARGET RPM", &active.targetRPM, T_INT, C_PRESET, 0, VF_NONE},
+//  {"TRAVERSE ACCUMULATOR", &traverseAccumulator, T_LONG, C_RUNTIME, 0, VF_NONE},
+    {"TRAVERSE DEFAULT RAMP", &cfg.defaultRamp_T, T_INT, C_MACHINE, 0, VF_NONE},
+    {"TRAVERSE DIRECTION", &cfg.dirT, T_BOOL, C_MACHINE, 0, VF_DIRECTION},
+    {"TRAVERSE JERK", &cfg.jerk_T, T_INT, C_MACHINE, 0, VF_NONE},
+    {"TRAVERSE MAX SPEED", &cfg.maxRPM_T, T_INT, C_MACHINE, 0, VF_NONE},
+    {"TRAVERSE START SPEED", &cfg.startRPM_T, T_INT, C_MACHINE, 0, VF_NONE},
+    {"TRAVERSE STEPS PER REV", &cfg.stepsPerRevT, T_INT, C_MACHINE, 0, VF_NONE},
+    {"TURNS", &active.totalTurns, T_LONG, C_PRESET, 0, VF_NONE},
+    {"USE START OFFSET", &cfg.useStartOffset, T_BOOL, C_MACHINE, 0, VF_NONE},
+    {"WINDER DEFAULT RAMP", &cfg.defaultRamp_W, T_INT, C_MACHINE, 0, VF_NONE},
+    {"WINDER DIRECTION", &cfg.dirW, T_BOOL, C_MACHINE, 0, VF_DIRECTION},
+    {"WINDER JERK", &cfg.jerk_W, T_INT, C_MACHINE, 0, VF_NONE},
+    {"WINDER MAX SPEED", &cfg.maxRPM_W, T_INT, C_MACHINE, 0, VF_NONE},
+    {"WINDER START SPEED", &cfg.startRPM_W, T_INT, C_MACHINE, 0, VF_NONE},
+    {"WINDER STEPS PER REV", &cfg.stepsPerRevW, T_INT, C_MACHINE, 0, VF_NONE},
+    {"WIRE", &active.wireDia, T_FLOAT, C_PRESET, 0, VF_NONE}};
 
+constexpr int varCount = sizeof(varTable) / sizeof(VarMap);
 
-const int varCount = sizeof(varTable) / sizeof(VarMap);
+// Binary search needs strictly ascending labels, none a prefix of the next
+// (a label followed by a space must identify exactly one entry)
+constexpr bool varLabelLess(const char *a, const char *b) {
+  return *a != *b ? *a < *b : (*a != 0 && varLabelLess(a + 1, b + 1));
+}
+constexpr bool varLabelPrefix(const char *a, const char *b) {
+  return *a == 0 || (*a == *b && varLabelPrefix(a + 1, b + 1));
+}
+constexpr bool varTableSorted(int i) {
+  return i + 1 >= varCount ||
+         (varLabelLess(varTable[i].label, varTable[i + 1].label) &&
+          !varLabelPrefix(varTable[i].label, varTable[i + 1].label) &&
+          varTableSorted(i + 1));
+}
+static_assert(varTableSorted(0), "varTable must be sorted by label");
 
-void handleSet(String line);
-void handleGet(String line);
-bool parseBool(String val, String label);
+int findVar(const char *query);
+void printVar(int i);
+void handleSet(char *line);
+void handleGet(const char *line);
+bool parseBool(const char *val, uint8_t flags);
 
 #endif  // VARIABLES_H
\ No newline at end of file
@@ -1,155 +1,198 @@
 #include "variables.h"
 
+// Binary search over the label-sorted flash table. Returns the entry whose
+// label is the query or starts it (followed by a space), or -1.
+int findVar(const char *query) {
+  int lo = 0, hi = varCount - 1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    size_t labelLen = strlen_P(varTable[mid].label);
+    int cmp = strncasecmp_P(query, varTable[mid].label, labelLen);
+    if (cmp == 0) {
+      if (query[labelLen] == 0 || query[labelLen] == ' ')
+        return mid;
+      cmp = 1; // "WIREX" sorts after "WIRE"
+    }
+    if (cmp < 0)
+      hi = mid - 1;
+    else
+      lo = mid + 1;
+  }
+  return -1;
+}
+
 // --- COMMAND HANDLERS ---
 
-void handleSet(String query) {
-  query.trim();
+void handleSet(char *query) {
+  query = trimChar(query);
 
-  for (int i = 0; i < varCount; i++) {
-    size_t labelLen = strlen(varTable[i].label);
-    if (strncasecmp(query.c_str(), varTable[i].label, labelLen) == 0) {
-      String valStr = query.substring(labelLen);
-      valStr.trim();
-      if (valStr.length() == 0)
-        return;
+  int i = findVar(query);
+  if (i == -1) {
+    Serial.println(F("ERROR: Unknown parameter"));
+    return;
+  }
 
-      if (varTable[i].category == C_RUNTIME) {
-        Serial.println(F("ERROR: Runtime values are read-only."));
-        return;
-      }
+  VarMap var;
+  memcpy_P(&var, &varTable[i], sizeof(VarMap));
+  char *valStr = trimChar(query + strlen(var.label));
+  if (*valStr == 0)
+    return;
 
-      // Update RAM
-      switch (varTable[i].type) {
-        case T_FLOAT:
-          *(float *)varTable[i].ptr = valStr.toFloat();
-          break;
-        case T_INT:
-          *(int *)varTable[i].ptr = valStr.toInt();
-          break;
-        case T_LONG:
-          *(long *)varTable[i].ptr = valStr.toInt();
-          break;
-        case T_BOOL:
-          *(bool *)varTable[i].ptr = parseBool(valStr, String(varTable[i].label));
-          break;
-        case T_CHAR:
-          {
-            uint8_t limit = varTable[i].maxLen - 1;  // Zostawiamy 1 bajt na \0
-            strncpy((char *)varTable[i].ptr, valStr.c_str(), limit);
-            ((char *)varTable[i].ptr)[limit] = '\0';
-            break;
-          }
-      }
+  if (var.category == C_RUNTIME) {
+    Serial.println(F("ERROR: Runtime values are read-only."));
+    return;
+  }
 
-      // AUTO-SAVE for machine category only
-      if (varTable[i].category == C_MACHINE) {
-        EEPROM.put(EEPROM_CONF_ADDR, cfg);
-        Serial.println(F("SYSTEM: Machine config updated and saved to EEPROM. "));
-      } else {
-        Serial.println(F("SYSTEM: Preset parameter updated in RAM. "));
+  // Update RAM
+  switch (var.type) {
+    case T_FLOAT:
+      *(float *)var.ptr = atof(valStr);
+      break;
+    case T_INT:
+      *(int *)var.ptr = atoi(valStr);
+      break;
+    case T_LONG:
+      *(long *)var.ptr = atol(valStr);
+      break;
+    case T_BOOL:
+      *(bool *)var.ptr = parseBool(valStr, var.flags);
+      break;
+    case T_CHAR:
+      {
+        uint8_t limit = var.maxLen - 1;  // Zostawiamy 1 bajt na \0
+        strncpy((char *)var.ptr, valStr, limit);
+        ((char *)var.ptr)[limit] = '\0';
+        break;
       }
+  }
 
-      Serial.print(varTable[i].label);
-      Serial.print(F(" = "));
-      handleGet(varTable[i].label);
-      updateDerivedValues();
-      return;
-    }
+  // AUTO-SAVE for machine category only
+  if (var.category == C_MACHINE) {
+    saveMachineConfiguration();
+    if (configBatch)
+      Serial.println(F("SYSTEM: Machine config updated, saved on SET COMMIT. "));
+    else
+      Serial.println(F("SYSTEM: Machine config updated and saved to EEPROM. "));
+  } else {
+    Serial.println(F("SYSTEM: Preset parameter updated in RAM. "));
   }
-  Serial.println(F("ERROR: Unknown parameter"));
+
+  Serial.print(var.label);
+  Serial.print(F(" = "));
+  printVar(i);
+  updateDerivedValues();
 }
 
-void handleGet(String query) {
-  query.trim();
-  if (query.startsWith(F("GET "))) query.remove(0, 4);
-  query.trim();
+// Prints one "[CATEGORY] LABEL: value" line
+void printVar(int i) {
+  VarMap var;
+  memcpy_P(&var, &varTable[i], sizeof(VarMap));
+
+  // Wypisywanie kategorii parametru
+  if (var.category == C_MACHINE) {
+    Serial.print(F("[MACHINE] "));
+  } else if (var.category == C_PRESET) {
+    Serial.print(F("[PRESET]  "));
+  } else {
+    Serial.print(F("[RUNTIME] "));
+  }
+
+  Serial.print(var.label);
+  Serial.print(F(": "));
+
+  switch (var.type) {
+    case T_CHAR:
+      Serial.println((const char *)var.ptr);
+      break;
+    case T_FLOAT:
+      Serial.println(*(const float *)var.ptr, 3);
+      break;
+    // Position and layer counters are written by the step ISR: copy them
+    // with interrupts off, or a multi-byte value may be torn
+    case T_INT:
+      {
+        int val;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { val = *(const int *)var.ptr; }
+        Serial.println(val);
+        break;
+      }
+    case T_LONG:
+      {
+        long val;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { val = *(const long *)var.ptr; }
+        Serial.println(val);
+        break;
+      }
+    case T_BOOL:
+      {
+        bool val = *(const bool *)var.ptr;
+        // Specjalna obsługa dla kierunków i przełączników
+        if (var.flags & VF_DIRECTION) {
+          Serial.println(val ? F("FORWARD") : F("BACKWARD"));
+        } else {
+          Serial.println(val ? F("ON") : F("OFF"));
+        }
+        break;
+      }
+  }
+}
+
+void handleGet(const char *query) {
+  while (*query == ' ') query++;
+  if (strncasecmp_P(query, PSTR("GET "), 4) == 0) query += 4;
+  while (*query == ' ') query++;
 
   // Identify if the request is for a specific category
   // -1: Not a category filter (searching for label or printing ALL)
   int filterCategory = -1;
-  if (query.equalsIgnoreCase(F("MACHINE"))) filterCategory = C_MACHINE;
-  else if (query.equalsIgnoreCase(F("PRESET"))) filterCategory = C_PRESET;
-  else if (query.equalsIgnoreCase(F("RUNTIME"))) filterCategory = C_RUNTIME;
+  if (strcasecmp_P(query, PSTR("MACHINE")) == 0) filterCategory = C_MACHINE;
+  else if (strcasecmp_P(query, PSTR("PRESET")) == 0) filterCategory = C_PRESET;
+  else if (strcasecmp_P(query, PSTR("RUNTIME")) == 0) filterCategory = C_RUNTIME;
 
-  bool showAll = (query.length() == 0);
+  bool showAll = (*query == 0);
+
+  if (!showAll && filterCategory == -1) {
+    // Single parameter: exact label only
+    int i = findVar(query);
+    if (i == -1 || query[strlen_P(varTable[i].label)] != 0) {
+      Serial.println(F("ERROR: Parameter or category not found"));
+      return;
+    }
+    printVar(i);
+    return;
+  }
 
   if (showAll) {
     Serial.println(F("ALL SETTINGS:"));
-  } else if (filterCategory != -1) {
+  } else {
     Serial.print(query);
     Serial.println(F(" SETTINGS:"));
   }
 
-  bool found = false;
-  for (int i = 0; i < varCount; i++) {
-    // Filtering logic:
-    // Show if: 1. It's 'GET' (all), 2. Category matches, 3. Label matches
-    bool categoryMatch = (filterCategory != -1 && varTable[i].category == filterCategory);
-    bool labelMatch = (strcasecmp(query.c_str(), varTable[i].label) == 0);
-
-    if (showAll || categoryMatch || labelMatch) {
-      found = true;
-
-      // Wypisywanie kategorii parametru
-      if (varTable[i].category == C_MACHINE) {
-        Serial.print(F("[MACHINE] "));
-      } else if (varTable[i].category == C_PRESET) {
-        Serial.print(F("[PRESET]  "));
-      } else {
-        Serial.print(F("[RUNTIME] "));
-      }
-
-      Serial.print(varTable[i].label);
-      Serial.print(F(": "));
-
-      switch (varTable[i].type) {
-        case T_CHAR:
-          Serial.println((char *)varTable[i].ptr);
-          break;
-        case T_FLOAT:
-          Serial.println(*(float *)varTable[i].ptr, 3);
-          break;
-        case T_INT:
-          Serial.println(*(int *)varTable[i].ptr);
-          break;
-        case T_LONG:
-          Serial.println(*(long *)varTable[i].ptr);
-          break;
-        case T_BOOL:
-          {
-            bool val = *(bool *)varTable[i].ptr;
-            // Specjalna obsługa dla kierunków i przełączników
-            if (strstr(varTable[i].label, "DIRECTION") != NULL) {
-              Serial.println(val ? F("FORWARD") : F("BACKWARD"));
-            } else {
-              Serial.println(val ? F("ON") : F("OFF"));
-            }
-            break;
-          }
-      }
+  // The table is sorted by label, so group the output by category here
+  for (uint8_t category = C_MACHINE; category <= C_RUNTIME; category++) {
+    if (!showAll && category != filterCategory)
+      continue;
+    for (int i = 0; i < varCount; i++) {
+      if (pgm_read_byte(&varTable[i].category) == category)
+        printVar(i);
     }
   }
-
-  if (!found) {
-    Serial.println(F("ERROR: Parameter or category not found"));
-  }
 }
 
 // Helper function to parse human-friendly boolean values
-bool parseBool(String val, String label) {
-  val.toUpperCase();
-  val.trim();
-
+bool parseBool(const char *val, uint8_t flags) {
   // Directions logic
-  if (label.indexOf(F("DIRECTION")) >= 0) {
-    if (val == F("FORWARD"))
+  if (flags & VF_DIRECTION) {
+    if (strcasecmp_P(val, PSTR("FORWARD")) == 0)
       return true;
-    if (val == F("BACKWARD"))
+    if (strcasecmp_P(val, PSTR("BACKWARD")) == 0)
       return false;
   }
 
   // Standard logic
-  if (val == F("ON") || val == F("1") || val == F("TRUE") || val == F("YES"))
+  if (strcasecmp_P(val, PSTR("ON")) == 0 || strcmp_P(val, PSTR("1")) == 0 ||
+      strcasecmp_P(val, PSTR("TRUE")) == 0 || strcasecmp_P(val, PSTR("YES")) == 0)
     return true;
   return false;
-}
\ No newline at end of file
+}